@@ -0,0 +1,396 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ais.h"
+
+#include <cstring>
+
+// 6-bit value of each payload armoring character, 0xFF for characters that can't appear in a payload
+static const uint8_t armorTable[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// Characters of the 6-bit AIS text encoding
+static const char sixBitAscii[] = "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_ !\"#$%&'()*+,-./0123456789:;<=>?";
+
+static inline uint64_t loadBigEndian64(const uint8_t *p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// Extracts up to 32 bits starting at any bit position with a single 64-bit load
+static inline uint32_t getUnsigned(const uint8_t *payload, uint32_t start, uint32_t width)
+{
+    uint64_t word = loadBigEndian64(payload + start / 8);
+    return static_cast<uint32_t>((word << (start % 8)) >> (64 - width));
+}
+
+static inline int32_t getSigned(const uint8_t *payload, uint32_t start, uint32_t width)
+{
+    uint32_t value = getUnsigned(payload, start, width);
+    return static_cast<int32_t>(value << (32 - width)) >> (32 - width);
+}
+
+static void getText(const uint8_t *payload, uint32_t start, uint32_t length, char *result)
+{
+    uint32_t i;
+    for (i = 0; i < length; i++) {
+        char c = sixBitAscii[getUnsigned(payload, start + i * 6, 6)];
+        // '@' terminates the text
+        if (c == '@') {
+            break;
+        }
+        result[i] = c;
+    }
+
+    // Strip trailing spaces
+    while (i > 0 && result[i - 1] == ' ') {
+        i--;
+    }
+    result[i] = 0;
+}
+
+// Appends the 6-bit values of the armored characters to the bits already in the payload
+static bool appendPayload(uint8_t *payload, uint32_t &payloadBits, const char *chars, uint32_t length)
+{
+    if (payloadBits + length * 6 > NMEA_AIS_MAX_PAYLOAD_BITS) {
+        return false;
+    }
+
+    uint8_t *out = payload + payloadBits / 8;
+    uint32_t accumulatedBits = payloadBits % 8;
+    // Bits of an unfinished byte are picked up from where the previous fragment left them
+    uint64_t accumulator = accumulatedBits ? (*out >> (8 - accumulatedBits)) : 0;
+    uint32_t i = 0;
+
+    // Four characters give 24 bits at a time
+    for (; i + 4 <= length; i += 4) {
+        uint32_t a = armorTable[static_cast<uint8_t>(chars[i])];
+        uint32_t b = armorTable[static_cast<uint8_t>(chars[i + 1])];
+        uint32_t c = armorTable[static_cast<uint8_t>(chars[i + 2])];
+        uint32_t d = armorTable[static_cast<uint8_t>(chars[i + 3])];
+
+        if ((a | b | c | d) & 0xC0) {
+            return false;
+        }
+
+        accumulator = (accumulator << 24) | (a << 18) | (b << 12) | (c << 6) | d;
+        accumulatedBits += 24;
+
+        while (accumulatedBits >= 8) {
+            accumulatedBits -= 8;
+            *out++ = static_cast<uint8_t>(accumulator >> accumulatedBits);
+        }
+    }
+
+    for (; i < length; i++) {
+        uint32_t a = armorTable[static_cast<uint8_t>(chars[i])];
+        if (a & 0xC0) {
+            return false;
+        }
+
+        accumulator = (accumulator << 6) | a;
+        accumulatedBits += 6;
+
+        if (accumulatedBits >= 8) {
+            accumulatedBits -= 8;
+            *out++ = static_cast<uint8_t>(accumulator >> accumulatedBits);
+        }
+    }
+
+    if (accumulatedBits) {
+        *out = static_cast<uint8_t>(accumulator << (8 - accumulatedBits));
+    }
+
+    payloadBits += length * 6;
+    return true;
+}
+
+// Drops the fill bits and clears everything after the payload, so that fields
+// beyond the end of a short message read as zero
+static bool finishPayload(uint8_t *payload, uint32_t &payloadBits, uint32_t fillBits)
+{
+    if (fillBits > payloadBits) {
+        return false;
+    }
+
+    payloadBits -= fillBits;
+
+    uint32_t usedBytes = (payloadBits + 7) / 8;
+    if (payloadBits % 8) {
+        payload[usedBytes - 1] &= static_cast<uint8_t>(0xFF << (8 - payloadBits % 8));
+    }
+    memset(payload + usedBytes, 0, NMEA_AIS_PAYLOAD_BUFFER_SIZE - usedBytes);
+
+    return true;
+}
+
+static void decodePosition(const uint8_t *payload, uint32_t offset, NmeaAisPositionReport &position)
+{
+    // Class A and class B reports share the layout from speed over ground onwards, offset by 4 bits
+    position.speedOverGround = getUnsigned(payload, 50 - offset, 10) / 10.0;
+    position.positionAccuracy = static_cast<uint8_t>(getUnsigned(payload, 60 - offset, 1));
+    position.longitude = getSigned(payload, 61 - offset, 28) / 600000.0;
+    position.latitude = getSigned(payload, 89 - offset, 27) / 600000.0;
+    position.courseOverGround = getUnsigned(payload, 116 - offset, 12) / 10.0;
+    position.trueHeading = static_cast<uint16_t>(getUnsigned(payload, 128 - offset, 9));
+    position.timestamp = static_cast<uint8_t>(getUnsigned(payload, 137 - offset, 6));
+}
+
+static NmeaAisStatus decodeMessage(const uint8_t *payload, uint32_t payloadBits, NmeaAisMessage &msg)
+{
+    // Message type, repeat indicator and MMSI
+    if (payloadBits < 38) {
+        return NmeaAisStatus_Invalid;
+    }
+
+    msg.messageType = static_cast<uint8_t>(getUnsigned(payload, 0, 6));
+    msg.repeatIndicator = static_cast<uint8_t>(getUnsigned(payload, 6, 2));
+    msg.mmsi = getUnsigned(payload, 8, 30);
+    msg.payload = payload;
+    msg.payloadBits = payloadBits;
+
+    switch (msg.messageType) {
+    case 1:
+    case 2:
+    case 3:
+        // Class A position report
+
+        msg.position.navigationStatus = static_cast<uint8_t>(getUnsigned(payload, 38, 4));
+        msg.position.rateOfTurn = static_cast<int8_t>(getSigned(payload, 42, 8));
+        decodePosition(payload, 0, msg.position);
+        msg.position.raim = static_cast<uint8_t>(getUnsigned(payload, 148, 1));
+
+        break;
+    case 18:
+        // Class B position report
+
+        msg.position.navigationStatus = 15;
+        msg.position.rateOfTurn = -128;
+        decodePosition(payload, 4, msg.position);
+        msg.position.raim = static_cast<uint8_t>(getUnsigned(payload, 147, 1));
+
+        break;
+    case 5:
+        // Class A static and voyage related data
+
+        msg.staticData.imoNumber = getUnsigned(payload, 40, 30);
+        getText(payload, 70, 7, msg.staticData.callSign);
+        getText(payload, 112, 20, msg.staticData.shipName);
+        msg.staticData.shipType = static_cast<uint8_t>(getUnsigned(payload, 232, 8));
+        msg.staticData.toBow = static_cast<uint16_t>(getUnsigned(payload, 240, 9));
+        msg.staticData.toStern = static_cast<uint16_t>(getUnsigned(payload, 249, 9));
+        msg.staticData.toPort = static_cast<uint8_t>(getUnsigned(payload, 258, 6));
+        msg.staticData.toStarboard = static_cast<uint8_t>(getUnsigned(payload, 264, 6));
+        msg.staticData.etaMonth = static_cast<uint8_t>(getUnsigned(payload, 274, 4));
+        msg.staticData.etaDay = static_cast<uint8_t>(getUnsigned(payload, 278, 5));
+        msg.staticData.etaHour = static_cast<uint8_t>(getUnsigned(payload, 283, 5));
+        msg.staticData.etaMinute = static_cast<uint8_t>(getUnsigned(payload, 288, 6));
+        msg.staticData.draught = getUnsigned(payload, 294, 8) / 10.0;
+        getText(payload, 302, 20, msg.staticData.destination);
+
+        break;
+    case 24:
+        // Class B static data, sent in two separate parts
+
+        msg.staticData.partNumber = static_cast<uint8_t>(getUnsigned(payload, 38, 2));
+        if (0 == msg.staticData.partNumber) {
+            getText(payload, 40, 20, msg.staticData.shipName);
+        } else {
+            msg.staticData.shipType = static_cast<uint8_t>(getUnsigned(payload, 40, 8));
+            getText(payload, 48, 7, msg.staticData.vendorId);
+            getText(payload, 90, 7, msg.staticData.callSign);
+            msg.staticData.toBow = static_cast<uint16_t>(getUnsigned(payload, 132, 9));
+            msg.staticData.toStern = static_cast<uint16_t>(getUnsigned(payload, 141, 9));
+            msg.staticData.toPort = static_cast<uint8_t>(getUnsigned(payload, 150, 6));
+            msg.staticData.toStarboard = static_cast<uint8_t>(getUnsigned(payload, 156, 6));
+        }
+
+        break;
+    }
+
+    return NmeaAisStatus_Complete;
+}
+
+// Finds the slot of a partial message, or returns null
+static NmeaAisFragmentSlot *findSlot(NmeaAisDecoder &decoder, uint8_t sequenceId, char channel)
+{
+    for (uint32_t s = 0; s < NMEA_AIS_REASSEMBLY_SLOTS; s++) {
+        NmeaAisFragmentSlot &slot = decoder.slots[s];
+        if (slot.nextFragment != 0 && slot.sequenceId == sequenceId && slot.channel == channel) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+// Finds a free slot, or the least recently used one when the table is full
+static NmeaAisFragmentSlot *allocateSlot(NmeaAisDecoder &decoder)
+{
+    NmeaAisFragmentSlot *oldest = &decoder.slots[0];
+
+    for (uint32_t s = 0; s < NMEA_AIS_REASSEMBLY_SLOTS; s++) {
+        NmeaAisFragmentSlot &slot = decoder.slots[s];
+        if (slot.nextFragment == 0) {
+            return &slot;
+        }
+        if (slot.lastUsed < oldest->lastUsed) {
+            oldest = &slot;
+        }
+    }
+
+    return oldest;
+}
+
+static inline uint32_t fieldLength(const NmeaSentenceFields &fields, uint32_t k)
+{
+    return static_cast<uint32_t>(fields.fieldStart[k + 1] - fields.fieldStart[k] - 1);
+}
+
+static inline bool parseDigit(const char *chars, uint32_t length, uint8_t &result)
+{
+    if (length != 1 || chars[0] < '0' || chars[0] > '9') {
+        return false;
+    }
+
+    result = static_cast<uint8_t>(chars[0] - '0');
+    return true;
+}
+
+extern "C" {
+
+void nmeaAisInit(NmeaAisDecoder &decoder)
+{
+    memset(&decoder, 0, sizeof(NmeaAisDecoder));
+}
+
+NmeaAisStatus parseAivdmMessage(const char *chars, NmeaAisDecoder &decoder, NmeaAisMessage &msg)
+{
+    NmeaSentenceFields fields;
+
+    memset(&msg, 0, sizeof(NmeaAisMessage));
+
+    // Address, fragment count, fragment number, sequence ID, channel, payload, fill bits
+    if (!splitNmeaSentence(chars, '!', 7, fields) || fields.fieldCount != 7) {
+        return NmeaAisStatus_Invalid;
+    }
+
+    // Any talker, VDM or VDO
+    const char *address = chars + fields.fieldStart[0];
+    if (fieldLength(fields, 0) != 5 || address[2] != 'V' || address[3] != 'D' || (address[4] != 'M' && address[4] != 'O')) {
+        return NmeaAisStatus_Invalid;
+    }
+
+    uint8_t fragmentCount = 0;
+    uint8_t fragmentNumber = 0;
+    uint8_t sequenceId = 0;
+    uint8_t fillBits = 0;
+
+    if (!parseDigit(chars + fields.fieldStart[1], fieldLength(fields, 1), fragmentCount) ||
+        !parseDigit(chars + fields.fieldStart[2], fieldLength(fields, 2), fragmentNumber)) {
+        return NmeaAisStatus_Invalid;
+    }
+    if (0 == fragmentNumber || fragmentNumber > fragmentCount) {
+        return NmeaAisStatus_Invalid;
+    }
+    if (fieldLength(fields, 3) != 0 && !parseDigit(chars + fields.fieldStart[3], fieldLength(fields, 3), sequenceId)) {
+        return NmeaAisStatus_Invalid;
+    }
+    if (fieldLength(fields, 4) > 1 || !parseDigit(chars + fields.fieldStart[6], fieldLength(fields, 6), fillBits) || fillBits > 5) {
+        return NmeaAisStatus_Invalid;
+    }
+
+    msg.channel = fieldLength(fields, 4) ? chars[fields.fieldStart[4]] : 0;
+    msg.ownVessel = address[4] == 'O';
+
+    if (1 == fragmentCount) {
+        uint32_t payloadBits = 0;
+
+        if (!appendPayload(decoder.payload, payloadBits, chars + fields.fieldStart[5], fieldLength(fields, 5)) ||
+            !finishPayload(decoder.payload, payloadBits, fillBits)) {
+            return NmeaAisStatus_Invalid;
+        }
+
+        return decodeMessage(decoder.payload, payloadBits, msg);
+    }
+
+    NmeaAisFragmentSlot *slot = findSlot(decoder, sequenceId, msg.channel);
+
+    if (1 == fragmentNumber) {
+        // A new first fragment restarts an unfinished message with the same key
+        if (nullptr == slot) {
+            slot = allocateSlot(decoder);
+        }
+
+        slot->payloadBits = 0;
+        slot->sequenceId = sequenceId;
+        slot->channel = msg.channel;
+        slot->fragmentCount = fragmentCount;
+        slot->nextFragment = 1;
+    } else if (nullptr == slot) {
+        return NmeaAisStatus_Invalid;
+    }
+
+    if (slot->fragmentCount != fragmentCount || slot->nextFragment != fragmentNumber ||
+        !appendPayload(slot->payload, slot->payloadBits, chars + fields.fieldStart[5], fieldLength(fields, 5))) {
+        slot->nextFragment = 0;
+        return NmeaAisStatus_Invalid;
+    }
+
+    slot->lastUsed = ++decoder.clock;
+
+    if (fragmentNumber < fragmentCount) {
+        slot->nextFragment++;
+        return NmeaAisStatus_Incomplete;
+    }
+
+    // Last fragment, the payload stays in the slot until it is reused
+    slot->nextFragment = 0;
+
+    if (!finishPayload(slot->payload, slot->payloadBits, fillBits)) {
+        return NmeaAisStatus_Invalid;
+    }
+
+    return decodeMessage(slot->payload, slot->payloadBits, msg);
+}
+}
@@ -0,0 +1,147 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef NMEA_AIS_H
+#define NMEA_AIS_H
+
+#include "nmea.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Longest AIS message is 5 slots, 1008 bits
+#define NMEA_AIS_MAX_PAYLOAD_BITS 1008
+// Payload buffers are padded so that the bit extractor can always load a whole word
+#define NMEA_AIS_PAYLOAD_BUFFER_SIZE (NMEA_AIS_MAX_PAYLOAD_BITS / 8 + 8)
+
+// Number of multi-fragment messages that can be reassembled at the same time
+#ifndef NMEA_AIS_REASSEMBLY_SLOTS
+#    define NMEA_AIS_REASSEMBLY_SLOTS 8
+#endif // NMEA_AIS_REASSEMBLY_SLOTS
+
+enum NmeaAisStatus
+{
+    // Malformed sentence, bad checksum or fragment out of order
+    NmeaAisStatus_Invalid = 0,
+    // Fragment stored, waiting for the rest of the message
+    NmeaAisStatus_Incomplete = 1,
+    // Message decoded
+    NmeaAisStatus_Complete = 2,
+};
+
+// Message types 1, 2, 3 (class A) and 18 (class B)
+typedef struct NmeaAisPositionReport
+{
+    // Degrees, 91 / 181 when not available
+    double latitude;
+    double longitude;
+    // Knots, 102.3 when not available
+    double speedOverGround;
+    // Degrees, 360 when not available
+    double courseOverGround;
+    // Degrees, 511 when not available
+    uint16_t trueHeading;
+    // Encoded rate of turn, -128 when not available (class A only)
+    int8_t rateOfTurn;
+    // 15 when not defined (class A only)
+    uint8_t navigationStatus;
+    // Second of the UTC minute, 60 or above when not available
+    uint8_t timestamp;
+    uint8_t positionAccuracy;
+    uint8_t raim;
+} NmeaAisPositionReport;
+
+// Message types 5 (class A) and 24 (class B, part A or B)
+typedef struct NmeaAisStaticData
+{
+    // Type 24 only: 0 for part A (name), 1 for part B (everything else)
+    uint8_t partNumber;
+    uint32_t imoNumber;
+    char callSign[8];
+    char shipName[21];
+    char destination[21];
+    char vendorId[8];
+    uint8_t shipType;
+    // Meters from the reference point
+    uint16_t toBow;
+    uint16_t toStern;
+    uint8_t toPort;
+    uint8_t toStarboard;
+    uint8_t etaMonth;
+    uint8_t etaDay;
+    uint8_t etaHour;
+    uint8_t etaMinute;
+    // Meters
+    double draught;
+} NmeaAisStaticData;
+
+typedef struct NmeaAisMessage
+{
+    uint8_t messageType;
+    uint8_t repeatIndicator;
+    uint32_t mmsi;
+    char channel;
+    // VDO: sent by the own vessel
+    bool ownVessel;
+    // Filled for types 1, 2, 3 and 18
+    NmeaAisPositionReport position;
+    // Filled for types 5 and 24
+    NmeaAisStaticData staticData;
+    // Raw payload, most significant bit first, for the other message types.
+    // Points into the decoder and stays valid until the next call.
+    const uint8_t *payload;
+    uint32_t payloadBits;
+} NmeaAisMessage;
+
+typedef struct NmeaAisFragmentSlot
+{
+    uint8_t payload[NMEA_AIS_PAYLOAD_BUFFER_SIZE];
+    uint32_t payloadBits;
+    uint32_t lastUsed;
+    uint8_t sequenceId;
+    char channel;
+    uint8_t fragmentCount;
+    // 0 when the slot is free
+    uint8_t nextFragment;
+} NmeaAisFragmentSlot;
+
+typedef struct NmeaAisDecoder
+{
+    NmeaAisFragmentSlot slots[NMEA_AIS_REASSEMBLY_SLOTS];
+    // Single fragment messages are decoded here
+    uint8_t payload[NMEA_AIS_PAYLOAD_BUFFER_SIZE];
+    uint32_t clock;
+} NmeaAisDecoder;
+
+extern void nmeaAisInit(NmeaAisDecoder &decoder);
+
+// Parses an !AIVDM or !AIVDO sentence (any talker). Fragments of multi-fragment messages are
+// reassembled by sequence ID and channel, the message is decoded when its last fragment arrives.
+// When the table is full, the least recently used partial message is dropped.
+extern NmeaAisStatus parseAivdmMessage(const char *chars, NmeaAisDecoder &decoder, NmeaAisMessage &msg);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // NMEA_AIS_H
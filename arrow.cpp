@@ -0,0 +1,610 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "arrow.h"
+
+#include <cstring>
+
+// Minimal flatbuffers encoder for the Arrow IPC metadata (Schema.fbs, Message.fbs, File.fbs).
+// Tables are written front to back: a table is followed by the objects it refers to,
+// so every offset points forward as the format requires and nothing has to be moved.
+
+enum ArrowType
+{
+    ArrowType_Int = 2,
+    ArrowType_FloatingPoint = 3,
+    ArrowType_Date = 8,
+    ArrowType_Time = 9,
+};
+
+enum ArrowMessageHeader
+{
+    ArrowMessageHeader_Schema = 1,
+    ArrowMessageHeader_RecordBatch = 3,
+};
+
+// MetadataVersion.V5
+static const uint16_t arrowMetadataVersion = 4;
+
+static const uint32_t arrowContinuation = 0xFFFFFFFF;
+
+static const char arrowMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+static const uint8_t zeros[NMEA_ARROW_ALIGNMENT] = {};
+
+// The column buffers, the block list and the message prefixes are written as they are in memory,
+// while the schema declares little endian data
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The Arrow writer requires a little endian host.");
+
+typedef struct ArrowColumn
+{
+    const char *name;
+    ArrowType type;
+    // Int: bit width, FloatingPoint: precision, Date / Time: unit
+    uint16_t parameter;
+    uint32_t byteWidth;
+} ArrowColumn;
+
+static const ArrowColumn arrowColumns[NMEA_ARROW_COLUMN_COUNT] = {
+    // Seconds since midnight
+    {"time", ArrowType_Time, 0, 4},
+    // Days since the UNIX epoch
+    {"date", ArrowType_Date, 0, 4},
+    // Degrees
+    {"latitude", ArrowType_FloatingPoint, 2, 8},
+    {"longitude", ArrowType_FloatingPoint, 2, 8},
+    // Meters
+    {"altitude", ArrowType_FloatingPoint, 2, 8},
+    {"satellites", ArrowType_Int, 8, 1},
+    // GGA fix quality: 0, 1, 2 or 6
+    {"fix_status", ArrowType_Int, 8, 1},
+    {"speed_over_ground", ArrowType_FloatingPoint, 2, 8},
+    {"course_over_ground", ArrowType_FloatingPoint, 2, 8},
+};
+
+enum ArrowColumnIndex
+{
+    ArrowColumnIndex_Time = 0,
+    ArrowColumnIndex_Date,
+    ArrowColumnIndex_Latitude,
+    ArrowColumnIndex_Longitude,
+    ArrowColumnIndex_Altitude,
+    ArrowColumnIndex_Satellites,
+    ArrowColumnIndex_FixStatus,
+    ArrowColumnIndex_Speed,
+    ArrowColumnIndex_Course,
+};
+
+typedef struct FlatBuilder
+{
+    uint8_t *data;
+    uint32_t size;
+    uint32_t capacity;
+    bool overflow;
+} FlatBuilder;
+
+typedef struct FlatField
+{
+    uint16_t slot;
+    uint8_t size;
+    uint64_t value;
+} FlatField;
+
+static inline size_t alignUp(size_t x, size_t alignment)
+{
+    return (x + alignment - 1) / alignment * alignment;
+}
+
+// Reserves zeroed bytes, returns their position
+static uint32_t flatReserve(FlatBuilder &fb, uint32_t length)
+{
+    uint32_t position = fb.size;
+
+    if (fb.capacity - fb.size < length) {
+        fb.overflow = true;
+        return 0;
+    }
+
+    memset(fb.data + fb.size, 0, length);
+    fb.size += length;
+    return position;
+}
+
+// Pads so that size + extra is a multiple of alignment
+static void flatAlign(FlatBuilder &fb, uint32_t alignment, uint32_t extra = 0)
+{
+    flatReserve(fb, static_cast<uint32_t>(alignUp(fb.size + extra, alignment) - fb.size - extra));
+}
+
+static void flatPut(FlatBuilder &fb, uint32_t position, uint64_t value, uint32_t size)
+{
+    if (fb.overflow) {
+        return;
+    }
+
+    // Little endian
+    for (uint32_t i = 0; i < size; i++) {
+        fb.data[position + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// Makes the offset at position point to target
+static void flatLink(FlatBuilder &fb, uint32_t position, uint32_t target)
+{
+    flatPut(fb, position, target - position, 4);
+}
+
+// Writes a vtable followed by its table. Offset fields are written as 0 and their positions
+// are returned in positions, to be linked once the referenced object is written.
+static uint32_t flatTable(FlatBuilder &fb, const FlatField *fields, uint32_t count, uint32_t *positions)
+{
+    uint32_t slots = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (fields[i].slot + 1u > slots) {
+            slots = fields[i].slot + 1u;
+        }
+    }
+
+    flatAlign(fb, 2);
+    uint32_t vtable = flatReserve(fb, 4 + 2 * slots);
+
+    flatAlign(fb, 4);
+    uint32_t table = flatReserve(fb, 4);
+
+    for (uint32_t i = 0; i < count; i++) {
+        flatAlign(fb, fields[i].size);
+        uint32_t position = flatReserve(fb, fields[i].size);
+        flatPut(fb, position, fields[i].value, fields[i].size);
+        flatPut(fb, vtable + 4 + 2 * fields[i].slot, position - table, 2);
+        if (positions) {
+            positions[i] = position;
+        }
+    }
+
+    flatPut(fb, vtable, 4 + 2 * slots, 2);
+    flatPut(fb, vtable + 2, fb.size - table, 2);
+    flatPut(fb, table, table - vtable, 4);
+
+    return table;
+}
+
+// Writes the length of a vector whose elements are aligned to alignment, returns the position of the first element
+static uint32_t flatVector(FlatBuilder &fb, uint32_t length, uint32_t elementSize, uint32_t alignment)
+{
+    flatAlign(fb, alignment > 4 ? alignment : 4, 4);
+    uint32_t position = flatReserve(fb, 4);
+    flatPut(fb, position, length, 4);
+    flatReserve(fb, length * elementSize);
+    return position;
+}
+
+static uint32_t flatString(FlatBuilder &fb, const char *string)
+{
+    uint32_t length = static_cast<uint32_t>(strlen(string));
+
+    flatAlign(fb, 4);
+    uint32_t position = flatReserve(fb, 4 + length + 1);
+    flatPut(fb, position, length, 4);
+    if (!fb.overflow) {
+        memcpy(fb.data + position + 4, string, length);
+    }
+    return position;
+}
+
+static uint32_t flatColumnType(FlatBuilder &fb, const ArrowColumn &column)
+{
+    switch (column.type) {
+    case ArrowType_Int: {
+        // bitWidth, is_signed
+        FlatField fields[] = {{0, 4, column.parameter}, {1, 1, 0}};
+        return flatTable(fb, fields, 2, nullptr);
+    }
+    case ArrowType_Time: {
+        // unit, bitWidth
+        FlatField fields[] = {{0, 2, column.parameter}, {1, 4, 32}};
+        return flatTable(fb, fields, 2, nullptr);
+    }
+    default: {
+        // FloatingPoint precision or Date unit
+        FlatField fields[] = {{0, 2, column.parameter}};
+        return flatTable(fb, fields, 1, nullptr);
+    }
+    }
+}
+
+static uint32_t flatSchema(FlatBuilder &fb)
+{
+    // endianness: Little, fields
+    FlatField schemaFields[] = {{0, 2, 0}, {1, 4, 0}};
+    uint32_t schemaPositions[2];
+    uint32_t schema = flatTable(fb, schemaFields, 2, schemaPositions);
+
+    uint32_t vector = flatVector(fb, NMEA_ARROW_COLUMN_COUNT, 4, 4);
+    flatLink(fb, schemaPositions[1], vector);
+
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        // name, nullable, type_type, type, children
+        FlatField fields[] = {{0, 4, 0}, {1, 1, 1}, {2, 1, static_cast<uint64_t>(arrowColumns[c].type)}, {3, 4, 0}, {5, 4, 0}};
+        uint32_t positions[5];
+        uint32_t field = flatTable(fb, fields, 5, positions);
+        flatLink(fb, vector + 4 + 4 * c, field);
+
+        flatLink(fb, positions[0], flatString(fb, arrowColumns[c].name));
+        flatLink(fb, positions[3], flatColumnType(fb, arrowColumns[c]));
+        flatLink(fb, positions[4], flatVector(fb, 0, 4, 4));
+    }
+
+    return schema;
+}
+
+// Starts a Message with the root offset, returns the position of the header offset
+static uint32_t flatMessage(FlatBuilder &fb, ArrowMessageHeader headerType, uint64_t bodyLength)
+{
+    uint32_t root = flatReserve(fb, 4);
+
+    // version, header_type, header, bodyLength
+    FlatField fields[] = {{0, 2, arrowMetadataVersion}, {1, 1, static_cast<uint64_t>(headerType)}, {2, 4, 0}, {3, 8, bodyLength}};
+    uint32_t positions[4];
+    uint32_t message = flatTable(fb, fields, 4, positions);
+    flatLink(fb, root, message);
+
+    return positions[2];
+}
+
+static void flatBegin(FlatBuilder &fb, NmeaArrowWriter &writer)
+{
+    fb.data = writer.metadata;
+    fb.size = 0;
+    fb.capacity = NMEA_ARROW_METADATA_SIZE;
+    fb.overflow = false;
+}
+
+static bool writeBytes(NmeaArrowWriter &writer, const void *data, size_t length)
+{
+    if (0 == length) {
+        return true;
+    }
+    // Part of a message may already be out, so the output can't be repaired by writing again
+    if (writer.failed || !writer.write(writer.context, data, length)) {
+        writer.failed = true;
+        return false;
+    }
+
+    writer.position += length;
+    return true;
+}
+
+static bool writePadding(NmeaArrowWriter &writer, size_t length)
+{
+    while (length > 0) {
+        size_t chunk = length < sizeof(zeros) ? length : sizeof(zeros);
+        if (!writeBytes(writer, zeros, chunk)) {
+            return false;
+        }
+        length -= chunk;
+    }
+
+    return true;
+}
+
+// Writes an encapsulated message: continuation marker, metadata length, metadata padded to 8 bytes.
+// Returns the number of bytes written.
+static uint32_t writeMessage(NmeaArrowWriter &writer, FlatBuilder &fb)
+{
+    if (fb.overflow) {
+        writer.failed = true;
+        return 0;
+    }
+
+    uint32_t paddedSize = static_cast<uint32_t>(alignUp(fb.size, 8));
+    uint32_t prefix[2] = {arrowContinuation, paddedSize};
+
+    if (!writeBytes(writer, prefix, sizeof(prefix)) || !writeBytes(writer, fb.data, fb.size) || !writePadding(writer, paddedSize - fb.size)) {
+        return 0;
+    }
+
+    return sizeof(prefix) + paddedSize;
+}
+
+static inline int32_t daysSinceEpoch(int32_t year, int32_t month, int32_t day)
+{
+    // Days from civil, proleptic Gregorian calendar
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yearOfEra = year - era * 400;
+    int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static inline void setValue(NmeaArrowWriter &writer, uint32_t column, bool valid, const void *value)
+{
+    uint32_t row = writer.rowCount;
+    uint32_t width = arrowColumns[column].byteWidth;
+
+    if (valid) {
+        writer.validity[column][row / 8] |= static_cast<uint8_t>(1 << (row % 8));
+        memcpy(writer.values[column] + row * width, value, width);
+    } else {
+        writer.nullCount[column]++;
+        memset(writer.values[column] + row * width, 0, width);
+    }
+}
+
+static size_t validityBufferSize(uint32_t batchSize)
+{
+    return alignUp((batchSize + 7) / 8, NMEA_ARROW_ALIGNMENT);
+}
+
+static size_t valueBufferSize(uint32_t batchSize, uint32_t byteWidth)
+{
+    return alignUp(static_cast<size_t>(batchSize) * byteWidth, NMEA_ARROW_ALIGNMENT);
+}
+
+static void resetBatch(NmeaArrowWriter &writer)
+{
+    writer.rowCount = 0;
+
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        writer.nullCount[c] = 0;
+        memset(writer.validity[c], 0, validityBufferSize(writer.batchSize));
+    }
+}
+
+extern "C" {
+
+size_t nmeaArrowWriterBufferSize(NmeaArrowFormat format, uint32_t batchSize, uint32_t maxBatches)
+{
+    // Room to align the start of the buffer
+    size_t size = NMEA_ARROW_ALIGNMENT - 1;
+
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        size += validityBufferSize(batchSize);
+        size += valueBufferSize(batchSize, arrowColumns[c].byteWidth);
+    }
+
+    if (format == NmeaArrowFormat_File) {
+        size += sizeof(NmeaArrowBlock) * static_cast<size_t>(maxBatches);
+    }
+
+    return size;
+}
+
+bool nmeaArrowWriterInit(
+    NmeaArrowWriter &writer,
+    NmeaArrowFormat format,
+    uint32_t batchSize,
+    uint32_t maxBatches,
+    void *buffer,
+    size_t bufferSize,
+    NmeaArrowWriteFunction write,
+    void *context)
+{
+    if (0 == batchSize || bufferSize < nmeaArrowWriterBufferSize(format, batchSize, maxBatches)) {
+        return false;
+    }
+
+    writer.write = write;
+    writer.context = context;
+    writer.format = format;
+    writer.position = 0;
+    writer.failed = false;
+    writer.batchSize = batchSize;
+
+    // Carve the column buffers out of the caller's buffer
+    uint8_t *p = reinterpret_cast<uint8_t *>(alignUp(reinterpret_cast<uintptr_t>(buffer), NMEA_ARROW_ALIGNMENT));
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        writer.validity[c] = p;
+        p += validityBufferSize(batchSize);
+        writer.values[c] = p;
+        p += valueBufferSize(batchSize, arrowColumns[c].byteWidth);
+    }
+
+    writer.blocks = reinterpret_cast<NmeaArrowBlock *>(p);
+    writer.blockCount = 0;
+    writer.blockCapacity = (format == NmeaArrowFormat_File) ? maxBatches : 0;
+
+    resetBatch(writer);
+
+    if (format == NmeaArrowFormat_File && !writeBytes(writer, arrowMagic, sizeof(arrowMagic))) {
+        return false;
+    }
+
+    FlatBuilder fb;
+    flatBegin(fb, writer);
+    uint32_t header = flatMessage(fb, ArrowMessageHeader_Schema, 0);
+    flatLink(fb, header, flatSchema(fb));
+
+    return 0 != writeMessage(writer, fb);
+}
+
+bool nmeaArrowAppendFix(NmeaArrowWriter &writer, const NmeaGpggaMessage *gga, const NmeaGxrmcMessage *rmc)
+{
+    if (writer.failed || (nullptr == gga && nullptr == rmc)) {
+        return false;
+    }
+    // A full batch is written when the next row arrives, so a failure never leaves the row half stored
+    if (writer.rowCount == writer.batchSize && !nmeaArrowFlush(writer)) {
+        return false;
+    }
+    // The footer has no room for the batch this row would go into
+    if (writer.format == NmeaArrowFormat_File && writer.blockCount == writer.blockCapacity) {
+        return false;
+    }
+
+    NmeaTime time = gga ? gga->time : rmc->time;
+    int32_t seconds = time.hours * 3600 + time.minutes * 60 + time.seconds;
+    setValue(writer, ArrowColumnIndex_Time, true, &seconds);
+
+    bool dateValid = rmc && rmc->date.month >= 1 && rmc->date.month <= 12 && rmc->date.day >= 1;
+    int32_t days = dateValid ? daysSinceEpoch(2000 + rmc->date.year, rmc->date.month, rmc->date.day) : 0;
+    setValue(writer, ArrowColumnIndex_Date, dateValid, &days);
+
+    double latitude = gga ? gga->latitude : rmc->latitude;
+    double longitude = gga ? gga->longitude : rmc->longitude;
+    setValue(writer, ArrowColumnIndex_Latitude, true, &latitude);
+    setValue(writer, ArrowColumnIndex_Longitude, true, &longitude);
+
+    double altitude = gga ? gga->altitude : 0.0;
+    uint8_t satellites = gga ? gga->numberOfSatellites : 0;
+    uint8_t fixStatus = gga ? static_cast<uint8_t>(gga->fixStatus - NmeaGpggaFixStatus_Invalid) : 0;
+    setValue(writer, ArrowColumnIndex_Altitude, gga != nullptr, &altitude);
+    setValue(writer, ArrowColumnIndex_Satellites, gga != nullptr, &satellites);
+    setValue(writer, ArrowColumnIndex_FixStatus, gga != nullptr, &fixStatus);
+
+    double speed = rmc ? rmc->speedOverGround : 0.0;
+    double course = rmc ? rmc->courseOverGround : 0.0;
+    setValue(writer, ArrowColumnIndex_Speed, rmc != nullptr, &speed);
+    setValue(writer, ArrowColumnIndex_Course, rmc != nullptr, &course);
+
+    writer.rowCount++;
+    return true;
+}
+
+bool nmeaArrowFlush(NmeaArrowWriter &writer)
+{
+    if (writer.failed) {
+        return false;
+    }
+    if (0 == writer.rowCount) {
+        return true;
+    }
+    // Rows are only accepted when there is room for their batch in the footer
+    if (writer.format == NmeaArrowFormat_File && writer.blockCount == writer.blockCapacity) {
+        return false;
+    }
+
+    // Every buffer starts at a multiple of NMEA_ARROW_ALIGNMENT in the body
+    size_t validityLength = (writer.rowCount + 7) / 8;
+    size_t bodyLength = 0;
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        bodyLength += alignUp(validityLength, NMEA_ARROW_ALIGNMENT);
+        bodyLength += alignUp(static_cast<size_t>(writer.rowCount) * arrowColumns[c].byteWidth, NMEA_ARROW_ALIGNMENT);
+    }
+
+    FlatBuilder fb;
+    flatBegin(fb, writer);
+    uint32_t header = flatMessage(fb, ArrowMessageHeader_RecordBatch, bodyLength);
+
+    // length, nodes, buffers
+    FlatField fields[] = {{0, 8, writer.rowCount}, {1, 4, 0}, {2, 4, 0}};
+    uint32_t positions[3];
+    flatLink(fb, header, flatTable(fb, fields, 3, positions));
+
+    // FieldNode: length, null_count
+    uint32_t nodes = flatVector(fb, NMEA_ARROW_COLUMN_COUNT, 16, 8);
+    flatLink(fb, positions[1], nodes);
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        flatPut(fb, nodes + 4 + 16 * c, writer.rowCount, 8);
+        flatPut(fb, nodes + 4 + 16 * c + 8, writer.nullCount[c], 8);
+    }
+
+    // Buffer: offset, length. Validity bitmap and values of each column.
+    uint32_t buffers = flatVector(fb, 2 * NMEA_ARROW_COLUMN_COUNT, 16, 8);
+    flatLink(fb, positions[2], buffers);
+    uint64_t offset = 0;
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        size_t valuesLength = static_cast<size_t>(writer.rowCount) * arrowColumns[c].byteWidth;
+
+        flatPut(fb, buffers + 4 + 32 * c, offset, 8);
+        flatPut(fb, buffers + 4 + 32 * c + 8, validityLength, 8);
+        offset += alignUp(validityLength, NMEA_ARROW_ALIGNMENT);
+
+        flatPut(fb, buffers + 4 + 32 * c + 16, offset, 8);
+        flatPut(fb, buffers + 4 + 32 * c + 24, valuesLength, 8);
+        offset += alignUp(valuesLength, NMEA_ARROW_ALIGNMENT);
+    }
+
+    uint64_t messageOffset = writer.position;
+    uint32_t metaDataLength = writeMessage(writer, fb);
+    if (0 == metaDataLength) {
+        return false;
+    }
+
+    // The body is written straight from the column buffers
+    for (uint32_t c = 0; c < NMEA_ARROW_COLUMN_COUNT; c++) {
+        size_t valuesLength = static_cast<size_t>(writer.rowCount) * arrowColumns[c].byteWidth;
+
+        if (!writeBytes(writer, writer.validity[c], validityLength) ||
+            !writePadding(writer, alignUp(validityLength, NMEA_ARROW_ALIGNMENT) - validityLength) ||
+            !writeBytes(writer, writer.values[c], valuesLength) ||
+            !writePadding(writer, alignUp(valuesLength, NMEA_ARROW_ALIGNMENT) - valuesLength)) {
+            return false;
+        }
+    }
+
+    if (writer.format == NmeaArrowFormat_File) {
+        NmeaArrowBlock &block = writer.blocks[writer.blockCount++];
+        block.offset = static_cast<int64_t>(messageOffset);
+        block.metaDataLength = static_cast<int32_t>(metaDataLength);
+        block.reserved = 0;
+        block.bodyLength = static_cast<int64_t>(bodyLength);
+    }
+
+    resetBatch(writer);
+    return true;
+}
+
+bool nmeaArrowWriterFinish(NmeaArrowWriter &writer)
+{
+    if (!nmeaArrowFlush(writer)) {
+        return false;
+    }
+
+    // End of stream marker
+    uint32_t endOfStream[2] = {arrowContinuation, 0};
+    if (!writeBytes(writer, endOfStream, sizeof(endOfStream))) {
+        return false;
+    }
+
+    if (writer.format != NmeaArrowFormat_File) {
+        return true;
+    }
+
+    // Footer: version, schema, recordBatches. The blocks are the last object of the
+    // flatbuffer, so they are written straight from the writer instead of the scratch buffer.
+    FlatBuilder fb;
+    flatBegin(fb, writer);
+    uint32_t root = flatReserve(fb, 4);
+
+    FlatField fields[] = {{0, 2, arrowMetadataVersion}, {1, 4, 0}, {3, 4, 0}};
+    uint32_t positions[3];
+    flatLink(fb, root, flatTable(fb, fields, 3, positions));
+    flatLink(fb, positions[1], flatSchema(fb));
+
+    flatAlign(fb, 8, 4);
+    uint32_t blocks = flatReserve(fb, 4);
+    flatPut(fb, blocks, writer.blockCount, 4);
+    flatLink(fb, positions[2], blocks);
+
+    if (fb.overflow) {
+        writer.failed = true;
+        return false;
+    }
+
+    uint32_t footerLength = fb.size + writer.blockCount * static_cast<uint32_t>(sizeof(NmeaArrowBlock));
+
+    return writeBytes(writer, fb.data, fb.size) && writeBytes(writer, writer.blocks, writer.blockCount * sizeof(NmeaArrowBlock)) &&
+           writeBytes(writer, &footerLength, sizeof(footerLength)) && writeBytes(writer, arrowMagic, 6);
+}
+}
@@ -0,0 +1,129 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef NMEA_ARROW_H
+#define NMEA_ARROW_H
+
+#include "nmea.h"
+
+#ifdef __cplusplus
+#    include <cstddef>
+#else
+#    include "stddef.h"
+#endif // __cplusplus
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Columns of the written record batches:
+// time (time32[s]), date (date32), latitude, longitude, altitude (float64),
+// satellites, fix_status (uint8), speed_over_ground, course_over_ground (float64)
+#define NMEA_ARROW_COLUMN_COUNT 9
+
+// Column buffers are aligned and padded to this
+#define NMEA_ARROW_ALIGNMENT 64
+
+// Size of the scratch buffer for the flatbuffer encoded messages
+#define NMEA_ARROW_METADATA_SIZE 2048
+
+enum NmeaArrowFormat
+{
+    // Arrow IPC streaming format (.arrows)
+    NmeaArrowFormat_Stream = 0,
+    // Arrow IPC file format (.arrow / Feather v2), can be memory mapped by the readers
+    NmeaArrowFormat_File = 1,
+};
+
+// Called with every piece of output, returns false on error
+typedef bool (*NmeaArrowWriteFunction)(void *context, const void *data, size_t length);
+
+// Location of a record batch in the file, laid out as the Block struct of the Arrow footer
+typedef struct NmeaArrowBlock
+{
+    int64_t offset;
+    int32_t metaDataLength;
+    int32_t reserved;
+    int64_t bodyLength;
+} NmeaArrowBlock;
+
+static_assert(sizeof(NmeaArrowBlock) == 24, "Size of NmeaArrowBlock is expected to be 24.");
+
+typedef struct NmeaArrowWriter
+{
+    NmeaArrowWriteFunction write;
+    void *context;
+    NmeaArrowFormat format;
+    // Bytes written so far
+    uint64_t position;
+    // Set when the sink returned false. The output is incomplete then, every later call fails.
+    bool failed;
+
+    uint32_t batchSize;
+    uint32_t rowCount;
+    uint8_t *validity[NMEA_ARROW_COLUMN_COUNT];
+    uint8_t *values[NMEA_ARROW_COLUMN_COUNT];
+    uint32_t nullCount[NMEA_ARROW_COLUMN_COUNT];
+
+    // Record batches written so far, only kept for the footer of the file format
+    NmeaArrowBlock *blocks;
+    uint32_t blockCount;
+    uint32_t blockCapacity;
+
+    uint8_t metadata[NMEA_ARROW_METADATA_SIZE];
+} NmeaArrowWriter;
+
+// Returns the size of the buffer that nmeaArrowWriterInit needs.
+// maxBatches limits the number of record batches of the file format, it is ignored for streams.
+extern size_t nmeaArrowWriterBufferSize(NmeaArrowFormat format, uint32_t batchSize, uint32_t maxBatches);
+
+// Initializes a writer on top of a caller provided buffer and writes the schema.
+extern bool nmeaArrowWriterInit(
+    NmeaArrowWriter &writer,
+    NmeaArrowFormat format,
+    uint32_t batchSize,
+    uint32_t maxBatches,
+    void *buffer,
+    size_t bufferSize,
+    NmeaArrowWriteFunction write,
+    void *context);
+
+// Appends one row. Either message can be null, the columns only they provide are then null.
+// Time and position come from the GGA message when both are given.
+// A full batch of batchSize rows is written when the next row arrives.
+// Returns false when the row is not stored: writer.failed is set if the sink failed,
+// otherwise the file format has no room for another record batch in its footer.
+extern bool nmeaArrowAppendFix(NmeaArrowWriter &writer, const NmeaGpggaMessage *gga, const NmeaGxrmcMessage *rmc);
+
+// Writes the collected rows as a record batch, even if there are less than batchSize of them.
+// Returns false if the sink fails.
+extern bool nmeaArrowFlush(NmeaArrowWriter &writer);
+
+// Flushes, then writes the end of stream marker and the footer of the file format.
+// Returns false if the sink fails.
+extern bool nmeaArrowWriterFinish(NmeaArrowWriter &writer);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // NMEA_ARROW_H
@@ -0,0 +1,314 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fixtable.h"
+
+#include <cstring>
+
+static const uint32_t fixWords = sizeof(NmeaLatestFix) / sizeof(uint64_t);
+
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static inline uint64_t hashSourceId(uint64_t x)
+{
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+static inline bool isPowerOfTwo(uint32_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+static NmeaFixTableSlot *findSlot(const NmeaFixTable &table, uint64_t sourceId)
+{
+    // 0 marks free slots
+    if (0 == sourceId) {
+        return nullptr;
+    }
+
+    uint64_t hash = hashSourceId(sourceId);
+    const NmeaFixTableShard &shard = table.shards[hash & table.shardMask];
+    uint32_t start = static_cast<uint32_t>(hash >> 32);
+
+    for (uint32_t probe = 0; probe <= shard.slotMask; probe++) {
+        NmeaFixTableSlot &slot = shard.slots[(start + probe) & shard.slotMask];
+        uint64_t key = __atomic_load_n(&slot.sourceId, __ATOMIC_ACQUIRE);
+
+        if (key == sourceId) {
+            return &slot;
+        }
+        // Slots are never freed, so the source can't be further along the probe sequence
+        if (key == 0) {
+            return nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+static NmeaFixTableSlot *findOrInsertSlot(NmeaFixTable &table, uint64_t sourceId)
+{
+    // 0 marks free slots, writing through it would leave a fix in a slot that nobody owns
+    if (0 == sourceId) {
+        return nullptr;
+    }
+
+    uint64_t hash = hashSourceId(sourceId);
+    NmeaFixTableShard &shard = table.shards[hash & table.shardMask];
+    uint32_t start = static_cast<uint32_t>(hash >> 32);
+
+    for (uint32_t probe = 0; probe <= shard.slotMask; probe++) {
+        NmeaFixTableSlot &slot = shard.slots[(start + probe) & shard.slotMask];
+        uint64_t key = __atomic_load_n(&slot.sourceId, __ATOMIC_ACQUIRE);
+
+        if (key == sourceId) {
+            return &slot;
+        }
+        if (key != 0) {
+            continue;
+        }
+
+        // Reserve room in the shard before claiming the slot
+        if (__atomic_fetch_add(&shard.size, 1, __ATOMIC_RELAXED) >= shard.maxSize) {
+            __atomic_fetch_sub(&shard.size, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        }
+
+        uint64_t expected = 0;
+        if (__atomic_compare_exchange_n(&slot.sourceId, &expected, sourceId, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return &slot;
+        }
+
+        // Somebody else claimed the slot first
+        __atomic_fetch_sub(&shard.size, 1, __ATOMIC_RELAXED);
+        if (expected == sourceId) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+static inline uint32_t beginWrite(NmeaFixTableSlot &slot)
+{
+    for (;;) {
+        uint32_t sequence = __atomic_load_n(&slot.sequence, __ATOMIC_RELAXED);
+
+        if (0 == (sequence & 1) &&
+            __atomic_compare_exchange_n(&slot.sequence, &sequence, sequence + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            // Readers that see any of the following stores must also see the odd sequence
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return sequence;
+        }
+
+        cpuRelax();
+    }
+}
+
+static inline void endWrite(NmeaFixTableSlot &slot, uint32_t sequence)
+{
+    // 0 means never written, skip it when the counter wraps
+    uint32_t next = sequence + 2;
+    if (0 == next) {
+        next = 2;
+    }
+
+    __atomic_store_n(&slot.sequence, next, __ATOMIC_RELEASE);
+}
+
+static inline void loadFix(const NmeaFixTableSlot &slot, NmeaLatestFix &fix)
+{
+    uint64_t words[fixWords];
+    for (uint32_t i = 0; i < fixWords; i++) {
+        words[i] = __atomic_load_n(&slot.fix[i], __ATOMIC_RELAXED);
+    }
+    memcpy(&fix, words, sizeof(NmeaLatestFix));
+}
+
+static inline void storeFix(NmeaFixTableSlot &slot, const NmeaLatestFix &fix)
+{
+    uint64_t words[fixWords];
+    memcpy(words, &fix, sizeof(NmeaLatestFix));
+    for (uint32_t i = 0; i < fixWords; i++) {
+        __atomic_store_n(&slot.fix[i], words[i], __ATOMIC_RELAXED);
+    }
+}
+
+// Returns false if the slot was never written
+static bool readSlot(const NmeaFixTableSlot &slot, NmeaLatestFix &fix)
+{
+    for (;;) {
+        uint32_t before = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+
+        if (0 == before) {
+            return false;
+        }
+        if (before & 1) {
+            cpuRelax();
+            continue;
+        }
+
+        loadFix(slot, fix);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t after = __atomic_load_n(&slot.sequence, __ATOMIC_RELAXED);
+
+        if (before == after) {
+            return true;
+        }
+    }
+}
+
+extern "C" {
+
+bool nmeaFixTableInit(NmeaFixTable &table, NmeaFixTableShard *shards, uint32_t shardCount, NmeaFixTableSlot *slots, uint32_t slotsPerShard)
+{
+    if (!isPowerOfTwo(shardCount) || !isPowerOfTwo(slotsPerShard)) {
+        return false;
+    }
+
+    table.shards = shards;
+    table.shardMask = shardCount - 1;
+
+    for (uint32_t s = 0; s < shardCount; s++) {
+        shards[s].slots = slots + static_cast<uint64_t>(s) * slotsPerShard;
+        shards[s].slotMask = slotsPerShard - 1;
+        shards[s].size = 0;
+        // Keep the load factor at or below 7/8
+        shards[s].maxSize = slotsPerShard - slotsPerShard / 8;
+    }
+
+    memset(slots, 0, sizeof(NmeaFixTableSlot) * static_cast<uint64_t>(shardCount) * slotsPerShard);
+
+    return true;
+}
+
+bool nmeaFixTableUpdateGpgga(NmeaFixTable &table, uint64_t sourceId, uint64_t timestamp, const NmeaGpggaMessage &msg)
+{
+    NmeaFixTableSlot *slot = findOrInsertSlot(table, sourceId);
+    if (nullptr == slot) {
+        return false;
+    }
+
+    uint32_t sequence = beginWrite(*slot);
+
+    NmeaLatestFix fix;
+    loadFix(*slot, fix);
+
+    if (timestamp >= fix.timestamp) {
+        fix.timestamp = timestamp;
+        fix.latitude = msg.latitude;
+        fix.longitude = msg.longitude;
+        fix.altitude = static_cast<float>(msg.altitude);
+        fix.time = msg.time;
+        fix.numberOfSatellites = msg.numberOfSatellites;
+        fix.fixStatus = msg.fixStatus;
+        storeFix(*slot, fix);
+    }
+
+    endWrite(*slot, sequence);
+    return true;
+}
+
+bool nmeaFixTableUpdateGxrmc(NmeaFixTable &table, uint64_t sourceId, uint64_t timestamp, const NmeaGxrmcMessage &msg)
+{
+    NmeaFixTableSlot *slot = findOrInsertSlot(table, sourceId);
+    if (nullptr == slot) {
+        return false;
+    }
+
+    uint32_t sequence = beginWrite(*slot);
+
+    NmeaLatestFix fix;
+    loadFix(*slot, fix);
+
+    if (timestamp >= fix.timestamp) {
+        fix.timestamp = timestamp;
+        fix.latitude = msg.latitude;
+        fix.longitude = msg.longitude;
+        fix.speedOverGround = static_cast<float>(msg.speedOverGround);
+        fix.courseOverGround = static_cast<float>(msg.courseOverGround);
+        fix.time = msg.time;
+        fix.date = msg.date;
+        fix.validity = msg.validity;
+        fix.positioningMode = msg.positioningMode;
+        storeFix(*slot, fix);
+    }
+
+    endWrite(*slot, sequence);
+    return true;
+}
+
+bool nmeaFixTableLookup(const NmeaFixTable &table, uint64_t sourceId, NmeaLatestFix &fix)
+{
+    const NmeaFixTableSlot *slot = findSlot(table, sourceId);
+    if (nullptr == slot) {
+        return false;
+    }
+
+    return readSlot(*slot, fix);
+}
+
+uint32_t nmeaFixTableSnapshotShard(const NmeaFixTable &table, uint32_t shardIndex, NmeaFixTableEntry *entries, uint32_t capacity)
+{
+    if (shardIndex > table.shardMask) {
+        return 0;
+    }
+
+    const NmeaFixTableShard &shard = table.shards[shardIndex];
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i <= shard.slotMask && count < capacity; i++) {
+        const NmeaFixTableSlot &slot = shard.slots[i];
+        uint64_t sourceId = __atomic_load_n(&slot.sourceId, __ATOMIC_ACQUIRE);
+
+        if (0 != sourceId && readSlot(slot, entries[count].fix)) {
+            entries[count].sourceId = sourceId;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+uint32_t nmeaFixTableSnapshot(const NmeaFixTable &table, NmeaFixTableEntry *entries, uint32_t capacity)
+{
+    uint32_t count = 0;
+
+    for (uint32_t s = 0; s <= table.shardMask; s++) {
+        count += nmeaFixTableSnapshotShard(table, s, entries + count, capacity - count);
+    }
+
+    return count;
+}
+}
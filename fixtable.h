@@ -0,0 +1,122 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef NMEA_FIXTABLE_H
+#define NMEA_FIXTABLE_H
+
+#include "nmea.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define NMEA_CACHE_LINE_SIZE 64
+#define NMEA_CACHE_ALIGNED __attribute__((aligned(NMEA_CACHE_LINE_SIZE)))
+
+// Latest known fix of a source, merged from GGA and RMC messages.
+typedef struct NMEA_PACKED NmeaLatestFix
+{
+    // Caller defined, usually the receive time. Older updates than this are ignored.
+    uint64_t timestamp;
+    double latitude;
+    double longitude;
+    // From GGA
+    float altitude;
+    // From RMC
+    float speedOverGround;
+    float courseOverGround;
+    NmeaTime time;
+    NmeaDate date;
+    uint8_t numberOfSatellites;
+    NmeaGpggaFixStatus fixStatus;
+    NmeaGxrmcValidity validity;
+    NmeaGxrmcPositioningMode positioningMode;
+    uint8_t reserved[2];
+} NmeaLatestFix;
+
+static_assert(sizeof(NmeaLatestFix) == 48, "Size of NmeaLatestFix is expected to be 48.");
+
+// One slot per source. The sequence is a seqlock: odd while a writer is updating the slot,
+// 0 only before the first write.
+typedef struct NMEA_CACHE_ALIGNED NmeaFixTableSlot
+{
+    uint32_t sequence;
+    uint32_t reserved;
+    // 0 means the slot is free
+    uint64_t sourceId;
+    uint64_t fix[sizeof(NmeaLatestFix) / sizeof(uint64_t)];
+} NmeaFixTableSlot;
+
+static_assert(sizeof(NmeaFixTableSlot) == NMEA_CACHE_LINE_SIZE, "Size of NmeaFixTableSlot is expected to be one cache line.");
+
+typedef struct NMEA_CACHE_ALIGNED NmeaFixTableShard
+{
+    NmeaFixTableSlot *slots;
+    uint32_t slotMask;
+    // Number of used slots, inserts fail above maxSize to keep the probe sequences short
+    uint32_t size;
+    uint32_t maxSize;
+} NmeaFixTableShard;
+
+typedef struct NmeaFixTable
+{
+    NmeaFixTableShard *shards;
+    uint32_t shardMask;
+} NmeaFixTable;
+
+typedef struct NmeaFixTableEntry
+{
+    uint64_t sourceId;
+    NmeaLatestFix fix;
+} NmeaFixTableEntry;
+
+// Initializes a table on top of caller provided storage.
+// shardCount and slotsPerShard must be powers of two, slots must hold shardCount * slotsPerShard entries.
+// Returns false if the sizes are invalid.
+extern bool nmeaFixTableInit(NmeaFixTable &table, NmeaFixTableShard *shards, uint32_t shardCount, NmeaFixTableSlot *slots, uint32_t slotsPerShard);
+
+// Stores the position, altitude, time, satellites and fix status of a GGA message for a source.
+// Can be called from any number of threads.
+// Returns false if sourceId is 0 (reserved for free slots) or the shard of the source is full.
+extern bool nmeaFixTableUpdateGpgga(NmeaFixTable &table, uint64_t sourceId, uint64_t timestamp, const NmeaGpggaMessage &msg);
+
+// Stores the position, speed, course, time, date, validity and positioning mode of an RMC message for a source.
+// Can be called from any number of threads.
+// Returns false if sourceId is 0 (reserved for free slots) or the shard of the source is full.
+extern bool nmeaFixTableUpdateGxrmc(NmeaFixTable &table, uint64_t sourceId, uint64_t timestamp, const NmeaGxrmcMessage &msg);
+
+// Reads the latest fix of a source without blocking writers.
+// Returns false if the source has no fix yet.
+extern bool nmeaFixTableLookup(const NmeaFixTable &table, uint64_t sourceId, NmeaLatestFix &fix);
+
+// Copies the fixes of one shard into entries, for rendering shards in parallel.
+// Every entry is a consistent copy of its slot. Returns the number of entries written.
+extern uint32_t nmeaFixTableSnapshotShard(const NmeaFixTable &table, uint32_t shardIndex, NmeaFixTableEntry *entries, uint32_t capacity);
+
+// Copies the fixes of all shards into entries. Returns the number of entries written.
+extern uint32_t nmeaFixTableSnapshot(const NmeaFixTable &table, NmeaFixTableEntry *entries, uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // NMEA_FIXTABLE_H
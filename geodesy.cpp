@@ -0,0 +1,232 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "geodesy.h"
+
+#include <cmath>
+#include <cstring>
+
+// WGS84 ellipsoid
+static const double semiMajorAxis = 6378137.0;
+static const double flattening = 1.0 / 298.257223563;
+static const double eccentricitySquared = flattening * (2.0 - flattening);
+
+// Adding and subtracting this rounds a double below 2^51 to the nearest integer
+static const double roundingConstant = 6755399441055744.0;
+
+// Number of messages gathered into columns at a time
+static const uint32_t blockSize = 64;
+
+static inline void sinCosDegrees(double degrees, double &s, double &c)
+{
+    // Reduce to r in [-45, 45] degrees, degrees = quadrant * 90 + r
+    double rounded = degrees * (1.0 / 90.0) + roundingConstant;
+    double quadrant = rounded - roundingConstant;
+    double r = (degrees - quadrant * 90.0) * (M_PI / 180.0);
+    double r2 = r * r;
+
+    // Taylor polynomials, the first omitted terms are below 5e-17 for |r| <= pi / 4
+    double ps = -1.0 / 1307674368000.0;
+    ps = ps * r2 + 1.0 / 6227020800.0;
+    ps = ps * r2 - 1.0 / 39916800.0;
+    ps = ps * r2 + 1.0 / 362880.0;
+    ps = ps * r2 - 1.0 / 5040.0;
+    ps = ps * r2 + 1.0 / 120.0;
+    ps = ps * r2 - 1.0 / 6.0;
+    ps = r + r * r2 * ps;
+
+    double pc = 1.0 / 20922789888000.0;
+    pc = pc * r2 - 1.0 / 87178291200.0;
+    pc = pc * r2 + 1.0 / 479001600.0;
+    pc = pc * r2 - 1.0 / 3628800.0;
+    pc = pc * r2 + 1.0 / 40320.0;
+    pc = pc * r2 - 1.0 / 720.0;
+    pc = pc * r2 + 1.0 / 24.0;
+    pc = pc * r2 - 0.5;
+    pc = 1.0 + r2 * pc;
+
+    // Rotate by the quadrant: selects instead of branches. The low bits of the mantissa of rounded
+    // are the quadrant in two's complement, which avoids a float to integer conversion.
+    uint64_t bits;
+    memcpy(&bits, &rounded, sizeof(bits));
+    uint32_t q = static_cast<uint32_t>(bits);
+    double sine = (q & 1) ? pc : ps;
+    double cosine = (q & 1) ? ps : pc;
+    s = (q & 2) ? -sine : sine;
+    c = ((q + 1) & 2) ? -cosine : cosine;
+}
+
+static inline double primeVerticalRadius(double sinLatitude)
+{
+    // a / sqrt(1 - e^2 sin^2(lat)) as a series in x = e^2 sin^2(lat) <= 0.0067,
+    // which avoids the library call of sqrt. The omitted terms are below 1e-18.
+    double x = eccentricitySquared * sinLatitude * sinLatitude;
+    double p = 429.0 / 2048.0;
+    p = p * x + 231.0 / 1024.0;
+    p = p * x + 63.0 / 256.0;
+    p = p * x + 35.0 / 128.0;
+    p = p * x + 5.0 / 16.0;
+    p = p * x + 3.0 / 8.0;
+    p = p * x + 1.0 / 2.0;
+    p = p * x + 1.0;
+    return semiMajorAxis * p;
+}
+
+static inline void toEcef(double latitude, double longitude, double altitude, double &x, double &y, double &z)
+{
+    double sinLatitude;
+    double cosLatitude;
+    double sinLongitude;
+    double cosLongitude;
+    sinCosDegrees(latitude, sinLatitude, cosLatitude);
+    sinCosDegrees(longitude, sinLongitude, cosLongitude);
+
+    double n = primeVerticalRadius(sinLatitude);
+    double r = (n + altitude) * cosLatitude;
+    x = r * cosLongitude;
+    y = r * sinLongitude;
+    z = (n * (1.0 - eccentricitySquared) + altitude) * sinLatitude;
+}
+
+extern "C" {
+
+void nmeaSinCosDegrees(const double *__restrict__ degrees, double *__restrict__ sines, double *__restrict__ cosines, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        sinCosDegrees(degrees[i], sines[i], cosines[i]);
+    }
+}
+
+void nmeaGeodeticToEcef(
+    const double *__restrict__ latitudes,
+    const double *__restrict__ longitudes,
+    const double *__restrict__ altitudes,
+    double *__restrict__ x,
+    double *__restrict__ y,
+    double *__restrict__ z,
+    uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        toEcef(latitudes[i], longitudes[i], altitudes[i], x[i], y[i], z[i]);
+    }
+}
+
+void nmeaEnuFrameInit(NmeaEnuFrame &frame, double latitude, double longitude, double altitude)
+{
+    toEcef(latitude, longitude, altitude, frame.originX, frame.originY, frame.originZ);
+
+    // Computed once per frame, so the library functions are fine here
+    double sinLatitude = std::sin(latitude * M_PI / 180.0);
+    double cosLatitude = std::cos(latitude * M_PI / 180.0);
+    double sinLongitude = std::sin(longitude * M_PI / 180.0);
+    double cosLongitude = std::cos(longitude * M_PI / 180.0);
+
+    // East
+    frame.rotation[0] = -sinLongitude;
+    frame.rotation[1] = cosLongitude;
+    frame.rotation[2] = 0.0;
+    // North
+    frame.rotation[3] = -sinLatitude * cosLongitude;
+    frame.rotation[4] = -sinLatitude * sinLongitude;
+    frame.rotation[5] = cosLatitude;
+    // Up
+    frame.rotation[6] = cosLatitude * cosLongitude;
+    frame.rotation[7] = cosLatitude * sinLongitude;
+    frame.rotation[8] = sinLatitude;
+}
+
+void nmeaGeodeticToEnu(
+    const NmeaEnuFrame &frame,
+    const double *__restrict__ latitudes,
+    const double *__restrict__ longitudes,
+    const double *__restrict__ altitudes,
+    double *__restrict__ east,
+    double *__restrict__ north,
+    double *__restrict__ up,
+    uint32_t count)
+{
+    // Local copies, so the compiler knows they don't alias the outputs
+    const double ox = frame.originX;
+    const double oy = frame.originY;
+    const double oz = frame.originZ;
+    const double r0 = frame.rotation[0];
+    const double r1 = frame.rotation[1];
+    const double r3 = frame.rotation[3];
+    const double r4 = frame.rotation[4];
+    const double r5 = frame.rotation[5];
+    const double r6 = frame.rotation[6];
+    const double r7 = frame.rotation[7];
+    const double r8 = frame.rotation[8];
+
+    for (uint32_t i = 0; i < count; i++) {
+        double x;
+        double y;
+        double z;
+        toEcef(latitudes[i], longitudes[i], altitudes[i], x, y, z);
+
+        double dx = x - ox;
+        double dy = y - oy;
+        double dz = z - oz;
+        east[i] = r0 * dx + r1 * dy;
+        north[i] = r3 * dx + r4 * dy + r5 * dz;
+        up[i] = r6 * dx + r7 * dy + r8 * dz;
+    }
+}
+
+void nmeaGpggaToEcef(const NmeaGpggaMessage *messages, double *x, double *y, double *z, uint32_t count)
+{
+    double latitudes[blockSize];
+    double longitudes[blockSize];
+    double altitudes[blockSize];
+
+    for (uint32_t start = 0; start < count; start += blockSize) {
+        uint32_t n = (count - start < blockSize) ? (count - start) : blockSize;
+
+        for (uint32_t i = 0; i < n; i++) {
+            latitudes[i] = messages[start + i].latitude;
+            longitudes[i] = messages[start + i].longitude;
+            altitudes[i] = messages[start + i].altitude;
+        }
+
+        nmeaGeodeticToEcef(latitudes, longitudes, altitudes, x + start, y + start, z + start, n);
+    }
+}
+
+void nmeaGpggaToEnu(const NmeaEnuFrame &frame, const NmeaGpggaMessage *messages, double *east, double *north, double *up, uint32_t count)
+{
+    double latitudes[blockSize];
+    double longitudes[blockSize];
+    double altitudes[blockSize];
+
+    for (uint32_t start = 0; start < count; start += blockSize) {
+        uint32_t n = (count - start < blockSize) ? (count - start) : blockSize;
+
+        for (uint32_t i = 0; i < n; i++) {
+            latitudes[i] = messages[start + i].latitude;
+            longitudes[i] = messages[start + i].longitude;
+            altitudes[i] = messages[start + i].altitude;
+        }
+
+        nmeaGeodeticToEnu(frame, latitudes, longitudes, altitudes, east + start, north + start, up + start, n);
+    }
+}
+}
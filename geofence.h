@@ -0,0 +1,159 @@
+// This file is part of the C++ NMEA library.
+// Copyright (c) 2016-2019 Timur Kristóf
+// Licensed to you under the terms of the MIT license.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef NMEA_GEOFENCE_H
+#define NMEA_GEOFENCE_H
+
+#ifdef __cplusplus
+#    include <cstdint>
+#else
+#    include "stdint.h"
+#endif // __cplusplus
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Maximum number of fences a single source can be inside of at the same time.
+// Memberships beyond this are not tracked and produce no events.
+#ifndef NMEA_GEOFENCE_MAX_INSIDE
+#    define NMEA_GEOFENCE_MAX_INSIDE 16
+#endif // NMEA_GEOFENCE_MAX_INSIDE
+
+// Size of the event buffer that nmeaGeofenceUpdate needs in the worst case.
+#define NMEA_GEOFENCE_MAX_EVENTS (2 * NMEA_GEOFENCE_MAX_INSIDE)
+
+enum NmeaGeofenceShape
+{
+    NmeaGeofenceShape_Circle = 0,
+    NmeaGeofenceShape_Polygon = 1,
+};
+
+enum NmeaGeofenceEventType
+{
+    NmeaGeofenceEventType_Enter = 0,
+    NmeaGeofenceEventType_Exit = 1,
+};
+
+typedef struct NmeaGeofence
+{
+    // Bounding box in degrees
+    double minLatitude;
+    double maxLatitude;
+    double minLongitude;
+    double maxLongitude;
+
+    // Circle: center in degrees, radius in meters
+    double centerLatitude;
+    double centerLongitude;
+    double radiusSquared;
+    double longitudeScale;
+
+    // Polygon: range in the engine's vertex arrays (closed, first vertex repeated at the end)
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+
+    NmeaGeofenceShape shape;
+} NmeaGeofence;
+
+typedef struct NmeaGeofenceEngine
+{
+    // Fences, storage provided by the caller
+    NmeaGeofence *fences;
+    uint32_t fenceCount;
+    uint32_t fenceCapacity;
+
+    // Polygon vertices as separate latitude / longitude columns, storage provided by the caller
+    double *vertexLatitudes;
+    double *vertexLongitudes;
+    uint32_t vertexCount;
+    uint32_t vertexCapacity;
+
+    // Uniform grid over the union of fence bounding boxes.
+    // Cell c lists the fences cellFences[cellStart[c]] .. cellFences[cellStart[c + 1] - 1] in ascending order.
+    uint32_t *cellStart;
+    uint32_t cellCapacity;
+    uint32_t *cellFences;
+    uint32_t cellFenceCapacity;
+
+    double gridMinLatitude;
+    double gridMinLongitude;
+    double inverseCellSize;
+    uint32_t gridRows;
+    uint32_t gridColumns;
+} NmeaGeofenceEngine;
+
+typedef struct NmeaGeofenceSourceState
+{
+    // Indices of the fences the source is currently inside of, in ascending order
+    uint32_t inside[NMEA_GEOFENCE_MAX_INSIDE];
+    uint32_t insideCount;
+} NmeaGeofenceSourceState;
+
+typedef struct NmeaGeofenceEvent
+{
+    uint32_t fenceIndex;
+    NmeaGeofenceEventType type;
+} NmeaGeofenceEvent;
+
+// Initializes an engine on top of caller provided storage.
+// cellStart must hold cellCapacity + 1 entries.
+extern void nmeaGeofenceInit(
+    NmeaGeofenceEngine &engine,
+    NmeaGeofence *fences,
+    uint32_t fenceCapacity,
+    double *vertexLatitudes,
+    double *vertexLongitudes,
+    uint32_t vertexCapacity,
+    uint32_t *cellStart,
+    uint32_t cellCapacity,
+    uint32_t *cellFences,
+    uint32_t cellFenceCapacity);
+
+// Adds a circular fence. The circle must not cross the antimeridian: longitudes are not wrapped,
+// so the part of a circle beyond +-180 degrees never matches any fix.
+// Returns false when the engine is full.
+extern bool nmeaGeofenceAddCircle(NmeaGeofenceEngine &engine, double latitude, double longitude, double radiusInMeters, uint32_t &fenceIndex);
+
+// Adds a polygonal fence. The polygon must not cross the antimeridian.
+// Returns false when the engine is full or the polygon has less than 3 vertices.
+extern bool nmeaGeofenceAddPolygon(
+    NmeaGeofenceEngine &engine, const double *latitudes, const double *longitudes, uint32_t count, uint32_t &fenceIndex);
+
+// Builds the grid index. Must be called after adding fences and before evaluating fixes.
+// Returns false when cellFences is too small for the resulting grid.
+extern bool nmeaGeofenceBuildIndex(NmeaGeofenceEngine &engine);
+
+// Returns whether the given position is inside the given fence.
+extern bool nmeaGeofenceContains(const NmeaGeofenceEngine &engine, uint32_t fenceIndex, double latitude, double longitude);
+
+// Evaluates a fix of a source against all fences, writes the enter / exit events
+// relative to the previous state of the source and updates the state.
+// events must hold at least NMEA_GEOFENCE_MAX_EVENTS entries. Returns the number of events written.
+extern uint32_t nmeaGeofenceUpdate(
+    const NmeaGeofenceEngine &engine, NmeaGeofenceSourceState &state, double latitude, double longitude, NmeaGeofenceEvent *events);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // NMEA_GEOFENCE_H
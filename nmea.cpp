@@ -166,37 +166,126 @@ bool parseNmeaLatLng(const char *chars, uint32_t length, double &resultInDegrees
 
 extern "C" {
 
-static inline uint8_t charToHex(char c)
+// Highest number of commas in the supported sentences
+static const uint32_t gpggaMaxColons = 14;
+// NMEA 0183 4.10 adds the navigational status field
+static const uint32_t gxrmcMaxColons = 13;
+
+static inline bool charToHex(char c, uint8_t &result)
 {
-    uint8_t x = static_cast<uint8_t>(c - '0');
-    if (x > 9) {
-        x = static_cast<uint8_t>(c - 'A' + 10);
+    result = static_cast<uint8_t>(c - '0');
+    if (result > 9) {
+        result = static_cast<uint8_t>(c - 'A');
+        if (result > 5) {
+            return false;
+        }
+        result += 10;
     }
-    return x;
+    return true;
 }
 
-bool parseGpggaMessage(const char *chars, NmeaGpggaMessage &msg)
+static inline bool isSentenceEnd(char c)
+{
+    return c == 0 || c == '\r' || c == '\n';
+}
+
+// Checks the character at position i of a sentence, before anything else looks at it.
+// This bounds the work done on garbage: parsing stops at the first unprintable byte,
+// at a second asterisk, at anything following the two checksum digits and at the maximum sentence length.
+static inline bool isValidSentenceChar(const char *chars, uint32_t i, uint32_t asteriskPosition)
+{
+    uint8_t c = static_cast<uint8_t>(chars[i]);
+
+    if (c < 0x20 || c > 0x7E) {
+        return false;
+    }
+    // Leave room for "\r\n"
+    if (i >= NMEA_MAX_SENTENCE_LENGTH - 2) {
+        return false;
+    }
+    if (asteriskPosition != 0 && (i > asteriskPosition + 2 || c == '*')) {
+        return false;
+    }
+
+    return true;
+}
+
+static inline bool verifyChecksum(const char *chars, uint32_t length, uint32_t asteriskPosition, uint8_t calculatedChecksum)
+{
+    // The checksum must be exactly two hex digits after the asterisk
+    if (0 == asteriskPosition || length != asteriskPosition + 3) {
+        return false;
+    }
+
+    uint8_t high;
+    uint8_t low;
+    if (!charToHex(chars[asteriskPosition + 1], high) || !charToHex(chars[asteriskPosition + 2], low)) {
+        return false;
+    }
+
+    uint8_t receivedChecksum = static_cast<uint8_t>(high * 16 + low);
+    return receivedChecksum == calculatedChecksum;
+}
+
+bool splitNmeaSentence(const char *chars, char startChar, uint32_t maxFields, NmeaSentenceFields &fields)
 {
-    uint8_t i;
-    uint8_t colons = 0;
-    uint8_t previousColon = 0;
+    uint32_t i;
+    uint32_t colons = 0;
     uint8_t calculatedChecksum = 0;
-    uint8_t receivedChecksum = 0;
-    uint8_t asteriskPosition = 0;
+    uint32_t asteriskPosition = 0;
 
-    memset(&msg, 0, sizeof(NmeaGpggaMessage));
+    if (chars[0] != startChar || 0 == maxFields || maxFields > NMEA_MAX_FIELDS) {
+        return false;
+    }
 
-    for (i = 0; chars[i] != 0 && chars[i] != '\r'; i++) {
+    fields.fieldStart[0] = 1;
+
+    for (i = 0; !isSentenceEnd(chars[i]); i++) {
+        if (!isValidSentenceChar(chars, i, asteriskPosition)) {
+            return false;
+        }
         if (chars[i] == '*') {
             asteriskPosition = i;
         }
         if (i != 0 && asteriskPosition == 0) {
             calculatedChecksum ^= *reinterpret_cast<const uint8_t *>(chars + i);
         }
-        if (chars[i] != ',') {
+        if (chars[i] != ',' || asteriskPosition != 0) {
             continue;
         }
 
+        colons++;
+        if (colons >= maxFields) {
+            return false;
+        }
+        fields.fieldStart[colons] = static_cast<uint16_t>(i + 1);
+    }
+
+    if (!verifyChecksum(chars, i, asteriskPosition, calculatedChecksum)) {
+        return false;
+    }
+
+    fields.fieldStart[colons + 1] = static_cast<uint16_t>(asteriskPosition + 1);
+    fields.fieldCount = colons + 1;
+    return true;
+}
+
+bool parseGpggaMessage(const char *chars, NmeaGpggaMessage &msg)
+{
+    NmeaSentenceFields fields;
+
+    memset(&msg, 0, sizeof(NmeaGpggaMessage));
+
+    // Framing, length limits and checksum
+    if (!splitNmeaSentence(chars, '$', gpggaMaxColons + 1, fields)) {
+        return false;
+    }
+
+    // Field n follows the n-th comma. Each field is handled at the comma that ends it,
+    // so the last field, which ends at the asterisk, is never looked at.
+    for (uint32_t colons = 1; colons + 1 < fields.fieldCount; colons++) {
+        uint32_t previousColon = fields.fieldStart[colons] - 1;
+        uint32_t i = fields.fieldStart[colons + 1] - 1;
         char previousChar = chars[i - 1];
         double val;
 
@@ -293,42 +382,27 @@ bool parseGpggaMessage(const char *chars, NmeaGpggaMessage &msg)
             break;
         }
 
-        previousColon = i;
-        colons++;
     }
 
-    // Get received checksum
-    receivedChecksum = charToHex(chars[asteriskPosition + 1]);
-    receivedChecksum *= 16;
-    receivedChecksum += charToHex(chars[asteriskPosition + 2]);
-
-    // Compare checksums
-    bool result = receivedChecksum == calculatedChecksum;
-    return result;
+    return true;
 }
 
 bool parseGxrmcMessage(const char *chars, NmeaGxrmcMessage &msg)
 {
-    uint8_t i;
-    uint8_t colons = 0;
-    uint8_t previousColon = 0;
-    uint8_t calculatedChecksum = 0;
-    uint8_t receivedChecksum = 0;
-    uint8_t asteriskPosition = 0;
+    NmeaSentenceFields fields;
 
     memset(&msg, 0, sizeof(NmeaGpggaMessage));
 
-    for (i = 0; chars[i] != 0 && chars[i] != '\r'; i++) {
-        if (chars[i] == '*') {
-            asteriskPosition = i;
-        }
-        if (i != 0 && asteriskPosition == 0) {
-            calculatedChecksum ^= *reinterpret_cast<const uint8_t *>(chars + i);
-        }
-        if (chars[i] != ',') {
-            continue;
-        }
+    // Framing, length limits and checksum
+    if (!splitNmeaSentence(chars, '$', gxrmcMaxColons + 1, fields)) {
+        return false;
+    }
 
+    // Field n follows the n-th comma. Each field is handled at the comma that ends it,
+    // so the last field, which ends at the asterisk, is never looked at.
+    for (uint32_t colons = 1; colons + 1 < fields.fieldCount; colons++) {
+        uint32_t previousColon = fields.fieldStart[colons] - 1;
+        uint32_t i = fields.fieldStart[colons + 1] - 1;
         char previousChar = chars[i - 1];
         char nextChar = chars[i + 1];
         double val;
@@ -464,18 +538,9 @@ bool parseGxrmcMessage(const char *chars, NmeaGxrmcMessage &msg)
             break;
         }
 
-        previousColon = i;
-        colons++;
     }
 
-    // Get received checksum
-    receivedChecksum = charToHex(chars[asteriskPosition + 1]);
-    receivedChecksum *= 16;
-    receivedChecksum += charToHex(chars[asteriskPosition + 2]);
-
-    // Compare checksums
-    bool result = receivedChecksum == calculatedChecksum;
-    return result;
+    return true;
 }
 }
 
@@ -21,6 +21,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#ifndef NMEA_H
+#define NMEA_H
+
 #ifdef __cplusplus
 #    include <cstdint>
 #else
@@ -33,6 +36,16 @@ extern "C" {
 
 #define NMEA_PACKED __attribute__((packed))
 
+// Maximum length of a sentence including the leading '$' and the trailing "\r\n".
+// The standard allows 82 characters, define it higher when parsing longer proprietary sentences.
+// Longer input is rejected without being read past this limit.
+#ifndef NMEA_MAX_SENTENCE_LENGTH
+#    define NMEA_MAX_SENTENCE_LENGTH 82
+#endif // NMEA_MAX_SENTENCE_LENGTH
+
+// Maximum number of fields splitNmeaSentence can split a sentence into
+#define NMEA_MAX_FIELDS 32
+
 enum NMEA_PACKED NmeaGpggaFixStatus
 {
     NmeaGpggaFixStatus_Invalid = '0',
@@ -114,13 +127,26 @@ typedef struct NMEA_PACKED NmeaGxrmcMessage
 
 static_assert(sizeof(NmeaGxrmcMessage) == 40, "Size of NmeaGxrmcMessage is expected to be 40.");
 
+typedef struct NmeaSentenceFields
+{
+    // Offset of the first character of each field, the first field being the address (eg. "GPGGA").
+    // Field k is fieldStart[k + 1] - fieldStart[k] - 1 characters long, the last field ends at the '*'.
+    uint16_t fieldStart[NMEA_MAX_FIELDS + 1];
+    uint32_t fieldCount;
+} NmeaSentenceFields;
+
 extern bool parseInteger(const char *chars, uint32_t length, int32_t &result);
 
 extern bool parseGpggaMessage(const char *chars, NmeaGpggaMessage &msg);
 
 extern bool parseGxrmcMessage(const char *chars, NmeaGxrmcMessage &msg);
 
+// Validates the framing and checksum of a sentence starting with startChar ('$' or '!') and finds its fields.
+// Applies the same limits as the message parsers and rejects sentences with more than maxFields fields.
+extern bool splitNmeaSentence(const char *chars, char startChar, uint32_t maxFields, NmeaSentenceFields &fields);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
 
+#endif // NMEA_H
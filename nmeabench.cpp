@@ -0,0 +1,257 @@
+
+#include "nmea.h"
+#include "ais.h"
+#include "arrow.h"
+#include "geodesy.h"
+#include "geofence.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static const uint32_t iterations = 1000000;
+
+static volatile uint32_t sink;
+
+static double nowInNanoseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e9 + static_cast<double>(ts.tv_nsec);
+}
+
+// Cost of parsing a valid GGA sentence, the reference for the other inputs
+static double validSentenceCost;
+
+template <typename T>
+static double benchmark(const char *name, bool (*parser)(const char *, T &), const char *input, uint32_t length)
+{
+    T msg;
+    uint32_t accepted = 0;
+
+    double start = nowInNanoseconds();
+    for (uint32_t i = 0; i < iterations; i++) {
+        accepted += parser(input, msg) ? 1 : 0;
+    }
+    double elapsed = nowInNanoseconds() - start;
+    sink = accepted;
+
+    // Garbage is rejected after an unknown number of bytes, so it is compared per sentence:
+    // rejecting any input must not cost more than parsing a valid sentence.
+    double perSentence = elapsed / iterations;
+    double reference = validSentenceCost > 0.0 ? validSentenceCost : perSentence;
+    printf("%-32s %5u bytes %8.1f ns/sentence %6.2fx valid %s\n", name, length, perSentence, perSentence / reference, accepted ? "accepted" : "rejected");
+
+    return perSentence;
+}
+
+static void benchmarkAis(const char *name, const char *const *sentences, uint32_t count)
+{
+    static NmeaAisDecoder decoder;
+    NmeaAisMessage msg;
+    uint32_t complete = 0;
+
+    nmeaAisInit(decoder);
+
+    double start = nowInNanoseconds();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (uint32_t k = 0; k < count; k++) {
+            complete += parseAivdmMessage(sentences[k], decoder, msg) == NmeaAisStatus_Complete ? 1 : 0;
+        }
+    }
+    double elapsed = nowInNanoseconds() - start;
+    sink = complete;
+
+    printf("%-32s %8.1f ns/message %7.2f M messages/s\n", name, elapsed / complete, complete / elapsed * 1e3);
+}
+
+static void benchmarkEcef()
+{
+    static const uint32_t count = 4096;
+    static const uint32_t rounds = 1000;
+    static double latitudes[count];
+    static double longitudes[count];
+    static double altitudes[count];
+    static double x[count];
+    static double y[count];
+    static double z[count];
+
+    for (uint32_t i = 0; i < count; i++) {
+        latitudes[i] = -90.0 + 180.0 * i / count;
+        longitudes[i] = -180.0 + 360.0 * ((i * 7919) % count) / count;
+        altitudes[i] = i % 1000;
+    }
+
+    double start = nowInNanoseconds();
+    for (uint32_t r = 0; r < rounds; r++) {
+        nmeaGeodeticToEcef(latitudes, longitudes, altitudes, x, y, z, count);
+    }
+    double batch = nowInNanoseconds() - start;
+    sink = static_cast<uint32_t>(x[count / 2]);
+
+    // Same formula with the library sin / cos / sqrt
+    const double a = 6378137.0;
+    const double f = 1.0 / 298.257223563;
+    const double e2 = f * (2.0 - f);
+
+    start = nowInNanoseconds();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < count; i++) {
+            double lat = latitudes[i] * M_PI / 180.0;
+            double lon = longitudes[i] * M_PI / 180.0;
+            double n = a / sqrt(1.0 - e2 * sin(lat) * sin(lat));
+            x[i] = (n + altitudes[i]) * cos(lat) * cos(lon);
+            y[i] = (n + altitudes[i]) * cos(lat) * sin(lon);
+            z[i] = (n * (1.0 - e2) + altitudes[i]) * sin(lat);
+        }
+    }
+    double scalar = nowInNanoseconds() - start;
+    sink = static_cast<uint32_t>(x[count / 2]);
+
+    printf("%-32s %8.2f ns/point\n", "ECEF batch", batch / count / rounds);
+    printf("%-32s %8.2f ns/point\n", "ECEF scalar libm", scalar / count / rounds);
+}
+
+static void benchmarkGeofence()
+{
+    static const uint32_t fenceCount = 10000;
+    static const uint32_t cellCount = 16384;
+    static const uint32_t fixCount = 4096;
+    static const uint32_t rounds = 250;
+    static NmeaGeofence fences[fenceCount];
+    static double vertexLatitudes[fenceCount * 4];
+    static double vertexLongitudes[fenceCount * 4];
+    static uint32_t cellStart[cellCount + 1];
+    static uint32_t cellFences[1 << 20];
+    static double latitudes[fixCount];
+    static double longitudes[fixCount];
+
+    NmeaGeofenceEngine engine;
+    nmeaGeofenceInit(
+        engine, fences, fenceCount, vertexLatitudes, vertexLongitudes, fenceCount * 4, cellStart, cellCount, cellFences, sizeof(cellFences) / sizeof(cellFences[0]));
+
+    // Half circles, half quadrilaterals, scattered over a 10 x 10 degree region
+    srand(2);
+    for (uint32_t i = 0; i < fenceCount; i++) {
+        double latitude = 30.0 + 10.0 * rand() / RAND_MAX;
+        double longitude = 110.0 + 10.0 * rand() / RAND_MAX;
+        uint32_t fenceIndex;
+
+        if (i & 1) {
+            nmeaGeofenceAddCircle(engine, latitude, longitude, 500.0 + rand() % 5000, fenceIndex);
+        } else {
+            double size = 0.01 + 0.05 * rand() / RAND_MAX;
+            const double polygonLatitudes[] = {latitude, latitude, latitude + size, latitude + size * 0.5};
+            const double polygonLongitudes[] = {longitude, longitude + size, longitude + size, longitude};
+            nmeaGeofenceAddPolygon(engine, polygonLatitudes, polygonLongitudes, 4, fenceIndex);
+        }
+    }
+    if (!nmeaGeofenceBuildIndex(engine)) {
+        printf("Geofence index does not fit\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < fixCount; i++) {
+        latitudes[i] = 30.0 + 10.0 * rand() / RAND_MAX;
+        longitudes[i] = 110.0 + 10.0 * rand() / RAND_MAX;
+    }
+
+    NmeaGeofenceSourceState state;
+    state.insideCount = 0;
+    NmeaGeofenceEvent events[NMEA_GEOFENCE_MAX_EVENTS];
+    uint32_t eventCount = 0;
+
+    double start = nowInNanoseconds();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < fixCount; i++) {
+            eventCount += nmeaGeofenceUpdate(engine, state, latitudes[i], longitudes[i], events);
+        }
+    }
+    double elapsed = nowInNanoseconds() - start;
+    sink = eventCount;
+
+    printf("%-32s %8.2f ns/fix\n", "Geofence, 10k fences", elapsed / fixCount / rounds);
+}
+
+static bool discard(void *, const void *, size_t length)
+{
+    sink = static_cast<uint32_t>(length);
+    return true;
+}
+
+static void benchmarkArrow(const char *gga, const char *rmc)
+{
+    static uint8_t buffer[1 << 20];
+    NmeaArrowWriter writer;
+    NmeaGpggaMessage ggaMessage;
+    NmeaGxrmcMessage rmcMessage;
+
+    parseGpggaMessage(gga, ggaMessage);
+    parseGxrmcMessage(rmc, rmcMessage);
+    nmeaArrowWriterInit(writer, NmeaArrowFormat_Stream, 4096, 0, buffer, sizeof(buffer), discard, nullptr);
+
+    double start = nowInNanoseconds();
+    for (uint32_t i = 0; i < iterations; i++) {
+        nmeaArrowAppendFix(writer, &ggaMessage, (i & 1) ? &rmcMessage : nullptr);
+    }
+    nmeaArrowWriterFinish(writer);
+    double elapsed = nowInNanoseconds() - start;
+
+    printf("%-32s %8.2f ns/row\n", "Arrow stream, 4096 row batches", elapsed / iterations);
+}
+
+int main()
+{
+    static const char gpgga[] = "$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n";
+    static const char gprmc[] = "$GPRMC,102739.000,A,3150.7825,N,11711.9369,E,0.00,303.62,111214,,,D*6A\r\n";
+    static const char badChecksum[] = "$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5C\r\n";
+
+    // Worst cases: input that keeps looking like a sentence for as long as possible
+    static char noTerminator[4096];
+    memset(noTerminator, '1', sizeof(noTerminator) - 1);
+    memcpy(noTerminator, "$GPGGA,", 7);
+
+    static char commaFlood[4096];
+    memset(commaFlood, ',', sizeof(commaFlood) - 1);
+    commaFlood[0] = '$';
+
+    static char randomBytes[4096];
+    srand(1);
+    for (uint32_t i = 0; i < sizeof(randomBytes) - 1; i++) {
+        randomBytes[i] = static_cast<char>(1 + rand() % 255);
+    }
+    randomBytes[0] = '$';
+
+    static char randomPrintable[4096];
+    for (uint32_t i = 0; i < sizeof(randomPrintable) - 1; i++) {
+        randomPrintable[i] = static_cast<char>(0x20 + rand() % 0x5F);
+    }
+    randomPrintable[0] = '$';
+
+    validSentenceCost = benchmark("GGA valid", parseGpggaMessage, gpgga, strlen(gpgga));
+    benchmark("RMC valid", parseGxrmcMessage, gprmc, strlen(gprmc));
+    benchmark("GGA bad checksum", parseGpggaMessage, badChecksum, strlen(badChecksum));
+    benchmark("GGA no terminator", parseGpggaMessage, noTerminator, strlen(noTerminator));
+    benchmark("RMC no terminator", parseGxrmcMessage, noTerminator, strlen(noTerminator));
+    benchmark("GGA comma flood", parseGpggaMessage, commaFlood, strlen(commaFlood));
+    benchmark("RMC comma flood", parseGxrmcMessage, commaFlood, strlen(commaFlood));
+    benchmark("GGA random bytes", parseGpggaMessage, randomBytes, strlen(randomBytes));
+    benchmark("GGA random printable", parseGpggaMessage, randomPrintable, strlen(randomPrintable));
+
+    static const char *const aisPosition[] = {"!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C\r\n"};
+    static const char *const aisStatic[] = {
+        "!AIVDM,2,1,3,A,55?MbV02;H;s<HtKP00EHE:0@T4@Dl0000000016L961O5Gf0NSQEp6ClRh0,0*0C\r\n",
+        "!AIVDM,2,2,3,A,00000000000,2*27\r\n",
+    };
+
+    benchmarkAis("AIS type 1", aisPosition, 1);
+    benchmarkAis("AIS type 5, two fragments", aisStatic, 2);
+
+    benchmarkEcef();
+
+    benchmarkArrow(gpgga, gprmc);
+
+    benchmarkGeofence();
+}
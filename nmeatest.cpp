@@ -1,9 +1,16 @@
 
 #include "nmea.h"
+#include "ais.h"
+#include "arrow.h"
+#include "fixtable.h"
+#include "geodesy.h"
+#include "geofence.h"
 
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <cassert>
+#include <pthread.h>
 
 void IntegerParsing_TryParseCorrectInt32_Success()
 {
@@ -173,6 +180,666 @@ void GxrmcParsing_TryParseCorrectGnrmcMessage_Success()
     assert(fabs(message.courseOverGround - 118.03) < 0.00001);
 }
 
+void GpggaParsing_TryParseMalformedGpggaMessage_ErrorDetected()
+{
+    NmeaGpggaMessage message;
+    bool isValid = true;
+
+    // Missing '$'
+    isValid = parseGpggaMessage("GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", message);
+    assert(!isValid);
+
+    // Non-printable byte in a field that is otherwise ignored, the checksum is correct
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,\x01*5A\r\n", message);
+    assert(!isValid);
+
+    // Missing checksum
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,\r\n", message);
+    assert(!isValid);
+
+    // Second asterisk, the checksum after it is correct
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5*5B\r\n", message);
+    assert(!isValid);
+
+    // Garbage after the checksum
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B5B\r\n", message);
+    assert(!isValid);
+
+    // More fields than a GGA message has
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,,,*5B\r\n", message);
+    assert(!isValid);
+
+    // Line without terminator, longer than the index of the old parser could count
+    char line[1024];
+    memset(line, ',', sizeof(line));
+    memcpy(line, "$GPGGA,102604.000", 17);
+    isValid = parseGpggaMessage(line, message);
+    assert(!isValid);
+}
+
+void GxrmcParsing_TryParseMalformedGxrmcMessage_ErrorDetected()
+{
+    NmeaGxrmcMessage message;
+    bool isValid = true;
+
+    // Line feed only is accepted as the end of the sentence
+    isValid = parseGxrmcMessage("$GPRMC,102739.000,A,3150.7825,N,11711.9369,E,0.00,303.62,111214,,,D*6A\n", message);
+    assert(isValid);
+
+    // Invalid hex digit in the checksum
+    isValid = parseGxrmcMessage("$GPRMC,102739.000,A,3150.7825,N,11711.9369,E,0.00,303.62,111214,,,D*6G\r\n", message);
+    assert(!isValid);
+
+    // Longer than NMEA_MAX_SENTENCE_LENGTH
+    isValid = parseGxrmcMessage("$GPRMC,102739.000,A,3150.7825,N,11711.9369,E,0.00,303.62,111214,,,D00000000000000000000*6A\r\n", message);
+    assert(!isValid);
+}
+
+void Geofence_TryPolygonAndCircleContainment_Success()
+{
+    static NmeaGeofence fences[4];
+    static double vertexLatitudes[16];
+    static double vertexLongitudes[16];
+    static uint32_t cellStart[65];
+    static uint32_t cellFences[256];
+
+    NmeaGeofenceEngine engine;
+    nmeaGeofenceInit(engine, fences, 4, vertexLatitudes, vertexLongitudes, 16, cellStart, 64, cellFences, 256);
+
+    // L-shaped polygon around the test position
+    const double latitudes[] = {31.8, 31.8, 31.9, 31.9, 31.85, 31.85};
+    const double longitudes[] = {117.1, 117.3, 117.3, 117.25, 117.25, 117.1};
+    uint32_t polygon = 0;
+    uint32_t circle = 0;
+    bool isValid = false;
+
+    isValid = nmeaGeofenceAddPolygon(engine, latitudes, longitudes, 6, polygon);
+    assert(isValid);
+    isValid = nmeaGeofenceAddCircle(engine, 31.8464, 117.1989, 500.0, circle);
+    assert(isValid);
+    isValid = nmeaGeofenceBuildIndex(engine);
+    assert(isValid);
+
+    assert(nmeaGeofenceContains(engine, polygon, 31.82, 117.15));
+    assert(nmeaGeofenceContains(engine, polygon, 31.88, 117.28));
+    // In the notch of the L
+    assert(!nmeaGeofenceContains(engine, polygon, 31.88, 117.15));
+    assert(!nmeaGeofenceContains(engine, polygon, 31.70, 117.15));
+
+    assert(nmeaGeofenceContains(engine, circle, 31.8464, 117.2020));
+    assert(!nmeaGeofenceContains(engine, circle, 31.8464, 117.2100));
+}
+
+void Geofence_TryUpdateWithParsedFixes_EnterAndExitDetected()
+{
+    static NmeaGeofence fences[2];
+    static double vertexLatitudes[8];
+    static double vertexLongitudes[8];
+    static uint32_t cellStart[17];
+    static uint32_t cellFences[64];
+
+    NmeaGeofenceEngine engine;
+    nmeaGeofenceInit(engine, fences, 2, vertexLatitudes, vertexLongitudes, 8, cellStart, 16, cellFences, 64);
+
+    const double latitudes[] = {31.84, 31.84, 31.85, 31.85};
+    const double longitudes[] = {117.19, 117.20, 117.20, 117.19};
+    uint32_t polygon = 0;
+    uint32_t circle = 0;
+    bool isValid = false;
+
+    isValid = nmeaGeofenceAddPolygon(engine, latitudes, longitudes, 4, polygon);
+    assert(isValid);
+    isValid = nmeaGeofenceAddCircle(engine, 31.6, 117.0, 1000.0, circle);
+    assert(isValid);
+    isValid = nmeaGeofenceBuildIndex(engine);
+    assert(isValid);
+
+    NmeaGeofenceSourceState state;
+    state.insideCount = 0;
+    NmeaGeofenceEvent events[NMEA_GEOFENCE_MAX_EVENTS];
+    NmeaGpggaMessage message;
+    uint32_t eventCount = 0;
+
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", message);
+    assert(isValid);
+    eventCount = nmeaGeofenceUpdate(engine, state, message.latitude, message.longitude, events);
+    assert(1 == eventCount);
+    assert(polygon == events[0].fenceIndex);
+    assert(NmeaGeofenceEventType_Enter == events[0].type);
+
+    // Staying inside produces no events
+    eventCount = nmeaGeofenceUpdate(engine, state, message.latitude, message.longitude, events);
+    assert(0 == eventCount);
+
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,S,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*46\r\n", message);
+    assert(isValid);
+    eventCount = nmeaGeofenceUpdate(engine, state, message.latitude, message.longitude, events);
+    assert(1 == eventCount);
+    assert(polygon == events[0].fenceIndex);
+    assert(NmeaGeofenceEventType_Exit == events[0].type);
+    assert(0 == state.insideCount);
+}
+
+void FixTable_TryUpdateGpggaAndGxrmc_MergedFixFound()
+{
+    static NmeaFixTableShard shards[4];
+    static NmeaFixTableSlot slots[4 * 8];
+
+    NmeaFixTable table;
+    bool isValid = false;
+
+    isValid = nmeaFixTableInit(table, shards, 4, slots, 8);
+    assert(isValid);
+
+    NmeaGpggaMessage gga;
+    NmeaGxrmcMessage rmc;
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", gga);
+    assert(isValid);
+    isValid = parseGxrmcMessage("$GPRMC,102739.000,A,3150.7825,N,11711.9369,E,0.00,303.62,111214,,,D*6A\r\n", rmc);
+    assert(isValid);
+
+    NmeaLatestFix fix;
+    isValid = nmeaFixTableLookup(table, 42, fix);
+    assert(!isValid);
+
+    isValid = nmeaFixTableUpdateGpgga(table, 42, 100, gga);
+    assert(isValid);
+    isValid = nmeaFixTableUpdateGxrmc(table, 42, 200, rmc);
+    assert(isValid);
+    // Older than the stored fix, ignored
+    isValid = nmeaFixTableUpdateGpgga(table, 42, 150, gga);
+    assert(isValid);
+
+    isValid = nmeaFixTableLookup(table, 42, fix);
+    assert(isValid);
+    assert(200 == fix.timestamp);
+    assert(fabs(fix.latitude - (31.0 + (50.7825 / 60.0))) < 0.00001);
+    assert(fabs(fix.altitude - 57.7) < 0.001);
+    assert(4 == fix.numberOfSatellites);
+    assert(fabs(fix.courseOverGround - 303.62) < 0.001);
+    assert(fix.date.year == 14);
+    assert(fix.time.minutes == 27);
+    assert(NmeaGxrmcValidity_Valid == fix.validity);
+
+    NmeaFixTableEntry entries[32];
+    uint32_t entryCount = 0;
+    for (uint64_t sourceId = 1; sourceId <= 10; sourceId++) {
+        isValid = nmeaFixTableUpdateGpgga(table, sourceId, sourceId, gga);
+        assert(isValid);
+    }
+    entryCount = nmeaFixTableSnapshot(table, entries, 32);
+    assert(11 == entryCount);
+    entryCount = nmeaFixTableSnapshot(table, entries, 5);
+    assert(5 == entryCount);
+}
+
+void FixTable_TryFillTable_InsertRejected()
+{
+    static NmeaFixTableShard shards[1];
+    static NmeaFixTableSlot slots[8];
+
+    NmeaFixTable table;
+    bool isValid = false;
+
+    isValid = nmeaFixTableInit(table, shards, 1, slots, 6);
+    assert(!isValid);
+    isValid = nmeaFixTableInit(table, shards, 1, slots, 8);
+    assert(isValid);
+
+    NmeaGpggaMessage gga;
+    NmeaLatestFix fix;
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", gga);
+    assert(isValid);
+
+    // 0 marks free slots, it must not write into them
+    isValid = nmeaFixTableUpdateGpgga(table, 0, 1, gga);
+    assert(!isValid);
+    isValid = nmeaFixTableLookup(table, 0, fix);
+    assert(!isValid);
+    for (uint32_t i = 0; i < 8; i++) {
+        assert(0 == slots[i].sequence);
+    }
+
+    // Load factor is capped at 7/8
+    for (uint64_t sourceId = 1; sourceId <= 7; sourceId++) {
+        isValid = nmeaFixTableUpdateGpgga(table, sourceId, 1, gga);
+        assert(isValid);
+    }
+    isValid = nmeaFixTableUpdateGpgga(table, 8, 1, gga);
+    assert(!isValid);
+
+    // The sequence skips 0 when it wraps, so the fix doesn't look unwritten
+    for (uint32_t i = 0; i < 8; i++) {
+        if (7 == slots[i].sourceId) {
+            slots[i].sequence = 0xFFFFFFFE;
+        }
+    }
+    isValid = nmeaFixTableUpdateGpgga(table, 7, 2, gga);
+    assert(isValid);
+    isValid = nmeaFixTableLookup(table, 7, fix);
+    assert(isValid);
+    assert(2 == fix.timestamp);
+}
+
+static NmeaFixTable concurrentTable;
+
+static void *FixTable_ConcurrentWriter(void *)
+{
+    NmeaGpggaMessage gga;
+    memset(&gga, 0, sizeof(gga));
+
+    for (uint32_t i = 1; i <= 100000; i++) {
+        // Every field of a fix carries the same value, so a torn read is detectable
+        gga.latitude = i;
+        gga.longitude = i;
+        gga.altitude = i;
+        nmeaFixTableUpdateGpgga(concurrentTable, 1 + (i & 3), i, gga);
+    }
+
+    return nullptr;
+}
+
+void FixTable_TryConcurrentReadsAndWrites_NoTornFix()
+{
+    static NmeaFixTableShard shards[2];
+    static NmeaFixTableSlot slots[2 * 16];
+    bool isValid = nmeaFixTableInit(concurrentTable, shards, 2, slots, 16);
+    assert(isValid);
+
+    pthread_t writers[2];
+    for (pthread_t &writer : writers) {
+        pthread_create(&writer, nullptr, FixTable_ConcurrentWriter, nullptr);
+    }
+
+    for (uint32_t i = 0; i < 100000; i++) {
+        NmeaLatestFix fix;
+        if (nmeaFixTableLookup(concurrentTable, 1 + (i & 3), fix)) {
+            assert(fix.latitude == fix.timestamp);
+            assert(fix.longitude == fix.timestamp);
+            assert(fix.altitude == static_cast<float>(fix.timestamp));
+        }
+    }
+
+    for (pthread_t &writer : writers) {
+        pthread_join(writer, nullptr);
+    }
+
+    NmeaFixTableEntry entries[32];
+    uint32_t entryCount = nmeaFixTableSnapshot(concurrentTable, entries, 32);
+    assert(4 == entryCount);
+    for (uint32_t i = 0; i < 4; i++) {
+        assert(entries[i].fix.latitude == entries[i].fix.timestamp);
+    }
+}
+
+void AisParsing_TryParsePositionReports_Success()
+{
+    static NmeaAisDecoder decoder;
+    NmeaAisMessage message;
+    NmeaAisStatus status = NmeaAisStatus_Invalid;
+    nmeaAisInit(decoder);
+
+    status = parseAivdmMessage("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C\r\n", decoder, message);
+    assert(NmeaAisStatus_Complete == status);
+    assert(1 == message.messageType);
+    assert(477553000 == message.mmsi);
+    assert('B' == message.channel);
+    assert(!message.ownVessel);
+    assert(5 == message.position.navigationStatus);
+    assert(fabs(message.position.longitude + 122.345833) < 0.00001);
+    assert(fabs(message.position.latitude - 47.582833) < 0.00001);
+    assert(fabs(message.position.courseOverGround - 51.0) < 0.00001);
+    assert(181 == message.position.trueHeading);
+    assert(15 == message.position.timestamp);
+
+    status = parseAivdmMessage("!AIVDM,1,1,,B,B52K>;h00Fc>jpUlNV@icwpUl000,0*22\r\n", decoder, message);
+    assert(NmeaAisStatus_Complete == status);
+    assert(18 == message.messageType);
+    assert(338087471 == message.mmsi);
+    assert(fabs(message.position.speedOverGround - 0.1) < 0.00001);
+    assert(fabs(message.position.longitude + 74.072132) < 0.00001);
+    assert(fabs(message.position.latitude - 40.68454) < 0.00001);
+    assert(fabs(message.position.courseOverGround - 79.4) < 0.00001);
+    assert(511 == message.position.trueHeading);
+    assert(49 == message.position.timestamp);
+    assert(1 == message.position.raim);
+}
+
+void AisParsing_TryParseMultiFragmentStaticData_Success()
+{
+    static NmeaAisDecoder decoder;
+    NmeaAisMessage message;
+    NmeaAisStatus status = NmeaAisStatus_Invalid;
+    nmeaAisInit(decoder);
+
+    status = parseAivdmMessage("!AIVDM,2,1,3,A,55?MbV02;H;s<HtKP00EHE:0@T4@Dl0000000016L961O5Gf0NSQEp6ClRh0,0*0C\r\n", decoder, message);
+    assert(NmeaAisStatus_Incomplete == status);
+    // Other messages may arrive between the fragments
+    status = parseAivdmMessage("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C\r\n", decoder, message);
+    assert(NmeaAisStatus_Complete == status);
+    status = parseAivdmMessage("!AIVDM,2,2,3,A,00000000000,2*27\r\n", decoder, message);
+    assert(NmeaAisStatus_Complete == status);
+
+    assert(5 == message.messageType);
+    assert(351759000 == message.mmsi);
+    assert(424 == message.payloadBits);
+    assert(9134270 == message.staticData.imoNumber);
+    assert(0 == strcmp("3FOF8", message.staticData.callSign));
+    assert(0 == strcmp("EVER DIADEM", message.staticData.shipName));
+    assert(0 == strcmp("NEW YORK", message.staticData.destination));
+    assert(70 == message.staticData.shipType);
+    assert(225 == message.staticData.toBow);
+    assert(70 == message.staticData.toStern);
+    assert(1 == message.staticData.toPort);
+    assert(31 == message.staticData.toStarboard);
+    assert(5 == message.staticData.etaMonth);
+    assert(15 == message.staticData.etaDay);
+    assert(14 == message.staticData.etaHour);
+    assert(fabs(message.staticData.draught - 12.2) < 0.00001);
+
+    status = parseAivdmMessage("!AIVDM,1,1,,A,H42O55i18tMET000000000000000,0*5F\r\n", decoder, message);
+    assert(NmeaAisStatus_Complete == status);
+    assert(24 == message.messageType);
+    assert(0 == message.staticData.partNumber);
+    assert(0 == strcmp("PROGUY", message.staticData.shipName));
+
+    status = parseAivdmMessage("!AIVDO,1,1,,A,H42O55lti4hhhilD3nink01P=540,0*25\r\n", decoder, message);
+    assert(NmeaAisStatus_Complete == status);
+    assert(message.ownVessel);
+    assert(1 == message.staticData.partNumber);
+    assert(60 == message.staticData.shipType);
+    assert(0 == strcmp("1D00014", message.staticData.vendorId));
+    assert(0 == strcmp("TC6163", message.staticData.callSign));
+    assert(12 == message.staticData.toBow);
+    assert(4 == message.staticData.toStarboard);
+}
+
+void AisParsing_TryParseInvalidAivdmMessage_ErrorDetected()
+{
+    static NmeaAisDecoder decoder;
+    NmeaAisMessage message;
+    NmeaAisStatus status = NmeaAisStatus_Invalid;
+    nmeaAisInit(decoder);
+
+    // Bad checksum
+    status = parseAivdmMessage("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5D\r\n", decoder, message);
+    assert(NmeaAisStatus_Invalid == status);
+    // Not an AIS sentence
+    status = parseAivdmMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", decoder, message);
+    assert(NmeaAisStatus_Invalid == status);
+    // Second fragment without the first one
+    status = parseAivdmMessage("!AIVDM,2,2,3,A,00000000000,2*27\r\n", decoder, message);
+    assert(NmeaAisStatus_Invalid == status);
+}
+
+void Geodesy_TrySinCosDegrees_MatchesLibm()
+{
+    double degrees[721];
+    double sines[721];
+    double cosines[721];
+
+    for (uint32_t i = 0; i < 721; i++) {
+        degrees[i] = -360.0 + i + i * 0.001;
+    }
+    nmeaSinCosDegrees(degrees, sines, cosines, 721);
+
+    for (uint32_t i = 0; i < 721; i++) {
+        assert(fabs(sines[i] - sin(degrees[i] * M_PI / 180.0)) < 1.5e-15);
+        assert(fabs(cosines[i] - cos(degrees[i] * M_PI / 180.0)) < 1.5e-15);
+    }
+
+    // Large angles, up to the documented limit. fmod is exact, so libm gets the same angle.
+    const double largeDegrees[] = {1e9 + 0.5, -3e11 - 0.25, 1e12, 1e14 + 1.0, -9.99e14};
+    nmeaSinCosDegrees(largeDegrees, sines, cosines, 5);
+
+    for (uint32_t i = 0; i < 5; i++) {
+        double reduced = fmod(largeDegrees[i], 360.0) * M_PI / 180.0;
+        assert(fabs(sines[i] - sin(reduced)) < 1.5e-15);
+        assert(fabs(cosines[i] - cos(reduced)) < 1.5e-15);
+    }
+}
+
+void Geodesy_TryConvertGpggaToEcefAndEnu_Success()
+{
+    const double latitudes[] = {0.0, 90.0};
+    const double longitudes[] = {0.0, 0.0};
+    const double altitudes[] = {0.0, 10.0};
+    double x[2];
+    double y[2];
+    double z[2];
+
+    nmeaGeodeticToEcef(latitudes, longitudes, altitudes, x, y, z, 2);
+    assert(fabs(x[0] - 6378137.0) < 1e-6);
+    assert(fabs(y[0]) < 1e-6);
+    assert(fabs(z[0]) < 1e-6);
+    // Semi-minor axis plus altitude
+    assert(fabs(x[1]) < 1e-6);
+    assert(fabs(z[1] - (6356752.314245 + 10.0)) < 1e-5);
+
+    NmeaGpggaMessage messages[2];
+    bool isValid = false;
+
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", messages[0]);
+    assert(isValid);
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,W,1,4,3.13,57.7,M,0.0,M,,*49\r\n", messages[1]);
+    assert(isValid);
+
+    nmeaGpggaToEcef(messages, x, y, z, 2);
+    // Mirrored across the prime meridian
+    assert(fabs(x[0] - x[1]) < 1e-6);
+    assert(fabs(y[0] + y[1]) < 1e-6);
+    assert(fabs(sqrt(x[0] * x[0] + y[0] * y[0] + z[0] * z[0]) - 6372190.0) < 1000.0);
+
+    NmeaEnuFrame frame;
+    double east[2];
+    double north[2];
+    double up[2];
+    nmeaEnuFrameInit(frame, messages[0].latitude, messages[0].longitude - 0.001, messages[0].altitude - 1.0);
+    nmeaGpggaToEnu(frame, messages, east, north, up, 1);
+
+    // 0.001 degree of longitude is about 94.6 m at this latitude
+    assert(fabs(east[0] - 94.6) < 0.1);
+    assert(fabs(north[0]) < 0.01);
+    assert(fabs(up[0] - 1.0) < 0.01);
+}
+
+typedef struct ArrowTestSink
+{
+    uint8_t data[16384];
+    size_t size;
+    // Writes after this many fail
+    uint32_t writeLimit;
+    uint32_t writeCount;
+} ArrowTestSink;
+
+static void ArrowTestSink_Reset(ArrowTestSink &sink)
+{
+    sink.size = 0;
+    sink.writeLimit = UINT32_MAX;
+    sink.writeCount = 0;
+}
+
+static bool ArrowTestSink_Write(void *context, const void *data, size_t length)
+{
+    ArrowTestSink *sink = static_cast<ArrowTestSink *>(context);
+    if (sink->writeCount >= sink->writeLimit || sizeof(sink->data) - sink->size < length) {
+        return false;
+    }
+    memcpy(sink->data + sink->size, data, length);
+    sink->size += length;
+    sink->writeCount++;
+    return true;
+}
+
+static uint32_t ArrowTestSink_ReadUint32(const ArrowTestSink &sink, size_t position)
+{
+    uint32_t value;
+    memcpy(&value, sink.data + position, sizeof(value));
+    return value;
+}
+
+void Arrow_TryWriteStreamWithNulls_Success()
+{
+    static ArrowTestSink sink;
+    static uint8_t buffer[8192];
+    NmeaArrowWriter writer;
+    NmeaGpggaMessage gga;
+    NmeaGxrmcMessage rmc;
+    bool isValid = false;
+    ArrowTestSink_Reset(sink);
+
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", gga);
+    assert(isValid);
+    isValid = parseGxrmcMessage("$GPRMC,102739.000,A,3150.7825,N,11711.9369,E,0.00,303.62,111214,,,D*6A\r\n", rmc);
+    assert(isValid);
+
+    // Too small buffer
+    isValid = nmeaArrowWriterInit(writer, NmeaArrowFormat_Stream, 4, 0, buffer, 64, ArrowTestSink_Write, &sink);
+    assert(!isValid);
+
+    assert(nmeaArrowWriterBufferSize(NmeaArrowFormat_Stream, 4, 0) <= sizeof(buffer));
+    isValid = nmeaArrowWriterInit(writer, NmeaArrowFormat_Stream, 4, 0, buffer, sizeof(buffer), ArrowTestSink_Write, &sink);
+    assert(isValid);
+    assert(0 == reinterpret_cast<uintptr_t>(writer.values[0]) % NMEA_ARROW_ALIGNMENT);
+    assert(0xFFFFFFFF == ArrowTestSink_ReadUint32(sink, 0));
+    size_t schemaEnd = sink.size;
+    assert(0 == schemaEnd % 8);
+
+    isValid = nmeaArrowAppendFix(writer, nullptr, nullptr);
+    assert(!isValid);
+    isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+    assert(isValid);
+    isValid = nmeaArrowAppendFix(writer, nullptr, &rmc);
+    assert(isValid);
+    isValid = nmeaArrowAppendFix(writer, &gga, &rmc);
+    assert(isValid);
+    assert(3 == writer.rowCount);
+    assert(sink.size == schemaEnd);
+
+    // Validity bitmaps: GGA only columns are null in row 1, RMC only columns in row 0
+    assert(0x07 == writer.validity[0][0]);
+    assert(0x06 == writer.validity[1][0]);
+    assert(0x05 == writer.validity[4][0]);
+    assert(0x06 == writer.validity[8][0]);
+    assert(1 == writer.nullCount[1]);
+    assert(1 == writer.nullCount[6]);
+
+    // Time columns hold seconds since midnight, date days since the epoch
+    int32_t value;
+    memcpy(&value, writer.values[0], sizeof(value));
+    assert(10 * 3600 + 26 * 60 + 4 == value);
+    memcpy(&value, writer.values[1] + 4, sizeof(value));
+    assert(16415 == value);
+
+    // The fourth row fills the batch, which is written when the fifth row arrives
+    isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+    assert(isValid);
+    assert(4 == writer.rowCount);
+    assert(sink.size == schemaEnd);
+
+    isValid = nmeaArrowAppendFix(writer, &gga, &rmc);
+    assert(isValid);
+    assert(1 == writer.rowCount);
+    assert(sink.size > schemaEnd);
+    assert(0xFFFFFFFF == ArrowTestSink_ReadUint32(sink, schemaEnd));
+    assert(0 == sink.size % 8);
+
+    isValid = nmeaArrowWriterFinish(writer);
+    assert(isValid);
+    assert(0xFFFFFFFF == ArrowTestSink_ReadUint32(sink, sink.size - 8));
+    assert(0 == ArrowTestSink_ReadUint32(sink, sink.size - 4));
+    assert(sink.size == writer.position);
+}
+
+void Arrow_TryWriteFile_FooterWritten()
+{
+    static ArrowTestSink sink;
+    static uint8_t buffer[8192];
+    NmeaArrowWriter writer;
+    NmeaGpggaMessage gga;
+    bool isValid = false;
+    ArrowTestSink_Reset(sink);
+
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", gga);
+    assert(isValid);
+    isValid = nmeaArrowWriterInit(writer, NmeaArrowFormat_File, 2, 2, buffer, sizeof(buffer), ArrowTestSink_Write, &sink);
+    assert(isValid);
+    assert(0 == memcmp(sink.data, "ARROW1\0\0", 8));
+
+    for (uint32_t i = 0; i < 4; i++) {
+        isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+        assert(isValid);
+    }
+    assert(1 == writer.blockCount);
+    assert(2 == writer.rowCount);
+
+    // The second batch is the last one the footer has room for: it is written, the row is refused
+    isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+    assert(!isValid);
+    assert(!writer.failed);
+    assert(2 == writer.blockCount);
+    assert(0 == writer.rowCount);
+    assert(0xFFFFFFFF == ArrowTestSink_ReadUint32(sink, writer.blocks[0].offset));
+    assert(0xFFFFFFFF == ArrowTestSink_ReadUint32(sink, writer.blocks[1].offset));
+
+    // The batches already written stay readable
+    isValid = nmeaArrowWriterFinish(writer);
+    assert(isValid);
+    assert(0 == memcmp(sink.data + sink.size - 6, "ARROW1", 6));
+
+    ArrowTestSink_Reset(sink);
+    isValid = nmeaArrowWriterInit(writer, NmeaArrowFormat_File, 2, 2, buffer, sizeof(buffer), ArrowTestSink_Write, &sink);
+    assert(isValid);
+    isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+    assert(isValid);
+    isValid = nmeaArrowWriterFinish(writer);
+    assert(isValid);
+    assert(1 == writer.blockCount);
+    assert(0 == memcmp(sink.data + sink.size - 6, "ARROW1", 6));
+
+    // The footer ends with the blocks, followed by its length
+    uint32_t footerLength = ArrowTestSink_ReadUint32(sink, sink.size - 10);
+    assert(0 == memcmp(sink.data + sink.size - 10 - sizeof(NmeaArrowBlock), writer.blocks, sizeof(NmeaArrowBlock)));
+    assert(0 == ArrowTestSink_ReadUint32(sink, sink.size - 10 - footerLength - 4));
+    assert(0xFFFFFFFF == ArrowTestSink_ReadUint32(sink, sink.size - 10 - footerLength - 8));
+}
+
+void Arrow_TryWriteToFailingSink_ErrorIsSticky()
+{
+    static ArrowTestSink sink;
+    static uint8_t buffer[8192];
+    NmeaArrowWriter writer;
+    NmeaGpggaMessage gga;
+    bool isValid = false;
+    ArrowTestSink_Reset(sink);
+
+    isValid = parseGpggaMessage("$GPGGA,102604.000,3150.7815,N,11711.9352,E,1,4,3.13,57.7,M,0.0,M,,*5B\r\n", gga);
+    assert(isValid);
+    isValid = nmeaArrowWriterInit(writer, NmeaArrowFormat_Stream, 2, 0, buffer, sizeof(buffer), ArrowTestSink_Write, &sink);
+    assert(isValid);
+    for (uint32_t i = 0; i < 2; i++) {
+        isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+        assert(isValid);
+    }
+
+    // The sink fails in the middle of the record batch, after its metadata is out
+    sink.writeLimit = sink.writeCount + 3;
+    isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+    assert(!isValid);
+    assert(writer.failed);
+    size_t failedSize = sink.size;
+
+    // Nothing is written again, even once the sink works
+    sink.writeLimit = UINT32_MAX;
+    isValid = nmeaArrowAppendFix(writer, &gga, nullptr);
+    assert(!isValid);
+    isValid = nmeaArrowFlush(writer);
+    assert(!isValid);
+    isValid = nmeaArrowWriterFinish(writer);
+    assert(!isValid);
+    assert(sink.size == failedSize);
+}
+
 int main()
 {
     IntegerParsing_TryParseCorrectInt32_Success();
@@ -184,6 +851,21 @@ int main()
     GpggaParsing_TryParseGpggaMessageWithInvalidLatLng_ErrorDetected();
     GxrmcParsing_TryParseCorrectGprmcMessage_Success();
     GxrmcParsing_TryParseCorrectGnrmcMessage_Success();
+    GpggaParsing_TryParseMalformedGpggaMessage_ErrorDetected();
+    GxrmcParsing_TryParseMalformedGxrmcMessage_ErrorDetected();
+    Geofence_TryPolygonAndCircleContainment_Success();
+    Geofence_TryUpdateWithParsedFixes_EnterAndExitDetected();
+    FixTable_TryUpdateGpggaAndGxrmc_MergedFixFound();
+    FixTable_TryFillTable_InsertRejected();
+    FixTable_TryConcurrentReadsAndWrites_NoTornFix();
+    AisParsing_TryParsePositionReports_Success();
+    AisParsing_TryParseMultiFragmentStaticData_Success();
+    AisParsing_TryParseInvalidAivdmMessage_ErrorDetected();
+    Geodesy_TrySinCosDegrees_MatchesLibm();
+    Geodesy_TryConvertGpggaToEcefAndEnu_Success();
+    Arrow_TryWriteStreamWithNulls_Success();
+    Arrow_TryWriteFile_FooterWritten();
+    Arrow_TryWriteToFailingSink_ErrorIsSticky();
     
     printf("\033[32mSUCCESS\033[00m\n\n");
 }